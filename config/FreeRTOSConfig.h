@@ -59,6 +59,7 @@
  #define configUSE_COUNTING_SEMAPHORES           1
  #define configQUEUE_REGISTRY_SIZE               8
  #define configUSE_QUEUE_SETS                    1
+ #define configTASK_NOTIFICATION_ARRAY_ENTRIES   2
  #define configUSE_TIME_SLICING                  1
  #define configUSE_NEWLIB_REENTRANT              0
  #define configENABLE_BACKWARD_COMPATIBILITY     0
@@ -4,7 +4,31 @@
 // Generally you would define your own explicit list of lwIP options
 // (see https://www.nongnu.org/lwip/2_1_x/group__lwip__opts.html)
 //
+// lwIP integrado ao FreeRTOS (pico_cyw43_arch_lwip_sys_freertos): a pilha roda na thread tcpip
+// e os pacotes são processados assim que chegam, sem laço de polling
+#define NO_SYS                      0
+#define LWIP_SOCKET                 0
+
 // This example uses a common include to avoid repetition
 #include "lwipopts_examples_common.h"
 
+// Thread tcpip: executa os callbacks TCP do servidor web (parser, SHA-1 do WebSocket)
+#define TCPIP_THREAD_STACKSIZE      2048
+#define TCPIP_THREAD_PRIO           3
+#define TCPIP_MBOX_SIZE             8
+#define DEFAULT_THREAD_STACKSIZE    1024
+#define DEFAULT_RAW_RECVMBOX_SIZE   8
+#define DEFAULT_UDP_RECVMBOX_SIZE   8
+#define DEFAULT_TCP_RECVMBOX_SIZE   8
+#define DEFAULT_ACCEPTMBOX_SIZE     8
+#define LWIP_TIMEVAL_PRIVATE        0
+#define LWIP_TCPIP_CORE_LOCKING_INPUT 1
+
+// PCBs TCP: pool HTTP keep-alive (6) + canais SSE (4) + WebSocket (4)
+#define MEMP_NUM_TCP_PCB            14
+
+// Sistema de arquivos do httpd: assets comprimidos gerados por tools/makefsdata.py no build
+#define HTTPD_USE_CUSTOM_FSDATA     1
+#define HTTPD_FSDATA_FILE           "fsdata_custom.c"
+
 #endif
@@ -0,0 +1,236 @@
+#include "http_parser.h"
+#include <string.h>
+
+// Nomes dos cabeçalhos reconhecidos, em minúsculas e na ordem de http_header_t
+static const char *const http_header_names[HTTP_HEADER_COUNT] = {
+    "connection",
+    "upgrade",
+    "sec-websocket-key",
+    "if-none-match",
+    "accept-encoding",
+};
+
+static char to_lower(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? (char)(c + ('a' - 'A')) : c;
+}
+
+// Verifica se o token aparece em uma lista separada por vírgulas (ex.: "keep-alive, Upgrade"); parâmetros
+// depois de ';' (ex.: "gzip;q=0.8") são ignorados
+static bool value_has_token(const char *value, const char *token)
+{
+    size_t token_len = strlen(token);
+
+    while (*value)
+    {
+        while (*value == ' ' || *value == ',')
+            value++;
+
+        size_t i = 0;
+        while (i < token_len && to_lower(value[i]) == token[i])
+            i++;
+        if (i == token_len && (value[i] == '\0' || value[i] == ',' || value[i] == ' ' || value[i] == ';'))
+            return true;
+
+        while (*value && *value != ',')
+            value++;
+    }
+    return false;
+}
+
+// Aplica o valor de um cabeçalho reconhecido ao final da linha
+static void finish_header(http_parser_t *parser)
+{
+    while (parser->value_len > 0 && parser->value[parser->value_len - 1] == '\r')
+        parser->value_len--;
+    parser->value[parser->value_len] = '\0';
+
+    switch (parser->header)
+    {
+    case HTTP_HEADER_CONNECTION:
+        if (value_has_token(parser->value, "close"))
+            parser->connection_close = true;
+        if (value_has_token(parser->value, "keep-alive"))
+            parser->connection_keep_alive = true;
+        break;
+    case HTTP_HEADER_UPGRADE:
+        parser->upgrade_websocket = value_has_token(parser->value, "websocket");
+        break;
+    case HTTP_HEADER_WS_KEY:
+        memcpy(parser->ws_key, parser->value, parser->value_len + 1);
+        break;
+    case HTTP_HEADER_IF_NONE_MATCH:
+        memcpy(parser->etag, parser->value, parser->value_len + 1);
+        break;
+    case HTTP_HEADER_ACCEPT_ENCODING:
+        // Um valor cortado em HTTP_VALUE_MAX pode ter perdido o "gzip": na dúvida, não recusa
+        parser->gzip_refused = parser->value_len < HTTP_VALUE_MAX && !value_has_token(parser->value, "gzip") &&
+                               !value_has_token(parser->value, "*");
+        break;
+    default:
+        break;
+    }
+}
+
+// Prepara o parser para uma nova requisição
+void http_parser_init(http_parser_t *parser)
+{
+    memset(parser, 0, sizeof(*parser));
+    parser->state = HTTP_STATE_METHOD;
+    parser->header = HTTP_HEADER_NONE;
+}
+
+// Consome bytes da requisição sem copiá-la. Para ao final dos cabeçalhos (HTTP_STATE_DONE)
+// ou em erro, retornando quantos bytes foram usados; o restante pertence à próxima requisição.
+size_t http_parser_feed(http_parser_t *parser, const char *data, size_t len)
+{
+    size_t i = 0;
+
+    for (; i < len; i++)
+    {
+        char c = data[i];
+
+        if (parser->state == HTTP_STATE_DONE || parser->state == HTTP_STATE_ERROR)
+            break;
+
+        if (c == '\r')
+            continue; // Aceita tanto CRLF quanto LF
+
+        switch (parser->state)
+        {
+        case HTTP_STATE_METHOD:
+            if (c == ' ')
+            {
+                parser->method_buf[parser->token_len] = '\0';
+                if (strcmp(parser->method_buf, "GET") == 0)
+                    parser->method = HTTP_METHOD_GET;
+                else if (strcmp(parser->method_buf, "POST") == 0)
+                    parser->method = HTTP_METHOD_POST;
+                parser->token_len = 0;
+                parser->state = HTTP_STATE_PATH;
+            }
+            else if (c == '\n' && parser->token_len == 0)
+            {
+                // Linhas em branco antes da requisição são ignoradas (RFC 9112, seção 2.2)
+            }
+            else if (parser->token_len < sizeof(parser->method_buf) - 1 && c != '\n')
+                parser->method_buf[parser->token_len++] = c;
+            else
+                parser->state = HTTP_STATE_ERROR;
+            break;
+
+        case HTTP_STATE_PATH:
+            if (c == ' ')
+            {
+                parser->path[parser->path_len] = '\0';
+                parser->token_len = 0;
+                parser->state = HTTP_STATE_VERSION;
+            }
+            else if (c == '\n' || parser->path_len >= HTTP_PATH_MAX)
+                parser->state = HTTP_STATE_ERROR;
+            else
+                parser->path[parser->path_len++] = c;
+            break;
+
+        case HTTP_STATE_VERSION:
+            // "HTTP/1.x": apenas o dígito menor interessa
+            if (c == '\n')
+            {
+                parser->state = HTTP_STATE_HEADER_NAME;
+                parser->candidates = (1u << HTTP_HEADER_COUNT) - 1;
+                parser->token_len = 0;
+                parser->line_empty = true;
+            }
+            else if (parser->token_len++ == 7)
+                parser->version_minor = (uint8_t)(c - '0');
+            break;
+
+        case HTTP_STATE_HEADER_NAME:
+            if (c == '\n')
+            {
+                // Linha em branco encerra os cabeçalhos; uma linha sem ':' é ignorada
+                if (parser->line_empty)
+                    parser->state = HTTP_STATE_DONE;
+                parser->candidates = (1u << HTTP_HEADER_COUNT) - 1;
+                parser->token_len = 0;
+                parser->line_empty = true;
+            }
+            else if (c == ':')
+            {
+                parser->header = HTTP_HEADER_NONE;
+                for (uint8_t h = 0; h < HTTP_HEADER_COUNT; h++)
+                {
+                    if ((parser->candidates & (1u << h)) && http_header_names[h][parser->token_len] == '\0')
+                        parser->header = h;
+                }
+                parser->value_len = 0;
+                parser->state = HTTP_STATE_HEADER_SPACE;
+            }
+            else if (parser->candidates == 0)
+            {
+                // Nome desconhecido: pula direto até o ':' ou o fim da linha
+                while (i + 1 < len && data[i + 1] != ':' && data[i + 1] != '\n')
+                    i++;
+                parser->line_empty = false;
+            }
+            else
+            {
+                // Compara o nome com os cabeçalhos conhecidos à medida que chega, sem armazená-lo. Um
+                // candidato casou todos os caracteres anteriores, então o '\0' do nome o elimina.
+                // Percorre só os candidatos restantes (depois do prefixo comum costuma sobrar um).
+                char lower = to_lower(c);
+                for (uint8_t left = parser->candidates; left; left &= left - 1)
+                {
+                    uint8_t h = (uint8_t)__builtin_ctz(left);
+                    if (http_header_names[h][parser->token_len] != lower || lower == '\0')
+                        parser->candidates &= ~(1u << h);
+                }
+                if (parser->token_len < 0xFF)
+                    parser->token_len++;
+                parser->line_empty = false;
+            }
+            break;
+
+        case HTTP_STATE_HEADER_SPACE:
+            if (c == ' ' || c == '\t')
+                break;
+            parser->state = HTTP_STATE_HEADER_VALUE;
+            /* fall through */
+
+        case HTTP_STATE_HEADER_VALUE:
+            if (c == '\n')
+            {
+                if (parser->header != HTTP_HEADER_NONE)
+                    finish_header(parser);
+                parser->header = HTTP_HEADER_NONE;
+                parser->candidates = (1u << HTTP_HEADER_COUNT) - 1;
+                parser->token_len = 0;
+                parser->line_empty = true;
+                parser->state = HTTP_STATE_HEADER_NAME;
+            }
+            else if (parser->header == HTTP_HEADER_NONE)
+            {
+                // Valor de um cabeçalho descartado: pula até o fim da linha
+                const char *end = memchr(data + i, '\n', len - i);
+                i = (end ? (size_t)(end - data) : len) - 1;
+            }
+            else
+            {
+                // Valor reconhecido: copia até o fim da linha (ou do segmento) de uma vez, sem passar
+                // de HTTP_VALUE_MAX; o '\r' do fim da linha é retirado em finish_header
+                const char *end = memchr(data + i, '\n', len - i);
+                size_t n = (end ? (size_t)(end - data) : len) - i;
+                size_t room = HTTP_VALUE_MAX - parser->value_len;
+                memcpy(parser->value + parser->value_len, data + i, n < room ? n : room);
+                parser->value_len += n < room ? n : room;
+                i += n - 1;
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    return i;
+}
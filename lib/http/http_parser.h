@@ -0,0 +1,69 @@
+#ifndef HTTP_PARSER_H
+#define HTTP_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define HTTP_PATH_MAX 48  // Maior caminho aceito (incluindo a query string)
+#define HTTP_VALUE_MAX 28 // Maior valor de cabeçalho armazenado (Sec-WebSocket-Key tem 24)
+
+typedef enum
+{
+    HTTP_METHOD_UNKNOWN = 0,
+    HTTP_METHOD_GET,
+    HTTP_METHOD_POST,
+} http_method_t;
+
+typedef enum
+{
+    HTTP_STATE_METHOD = 0,   // Lendo o método
+    HTTP_STATE_PATH,         // Lendo o caminho
+    HTTP_STATE_VERSION,      // Lendo a versão até o fim da linha
+    HTTP_STATE_HEADER_NAME,  // Lendo o nome de um cabeçalho
+    HTTP_STATE_HEADER_SPACE, // Espaços depois do ':'
+    HTTP_STATE_HEADER_VALUE, // Lendo o valor de um cabeçalho
+    HTTP_STATE_DONE,         // Requisição completa (linha em branco recebida)
+    HTTP_STATE_ERROR,        // Requisição malformada ou grande demais
+} http_state_t;
+
+// Cabeçalhos reconhecidos pelo parser; os demais são descartados sem cópia
+typedef enum
+{
+    HTTP_HEADER_CONNECTION = 0,
+    HTTP_HEADER_UPGRADE,
+    HTTP_HEADER_WS_KEY,
+    HTTP_HEADER_IF_NONE_MATCH,
+    HTTP_HEADER_ACCEPT_ENCODING,
+    HTTP_HEADER_COUNT,
+    HTTP_HEADER_NONE = 0xFF,
+} http_header_t;
+
+typedef struct http_parser
+{
+    http_state_t state;              // Estado atual da máquina de estados
+    http_method_t method;            // Método da requisição
+    char path[HTTP_PATH_MAX + 1];    // Caminho requisitado ('\0' no final)
+    uint8_t path_len;                // Tamanho do caminho
+    uint8_t version_minor;           // 0 para HTTP/1.0, 1 para HTTP/1.1
+    bool connection_close;           // Cliente pediu "Connection: close"
+    bool connection_keep_alive;      // Cliente pediu "Connection: keep-alive"
+    bool upgrade_websocket;          // "Upgrade: websocket"
+    bool gzip_refused;               // Accept-Encoding presente sem "gzip" nem "*" (sem o cabeçalho, qualquer codificação serve)
+    char ws_key[HTTP_VALUE_MAX + 1]; // Sec-WebSocket-Key
+    char etag[HTTP_VALUE_MAX + 1];   // If-None-Match
+
+    // Estado interno da leitura de tokens
+    uint8_t token_len;               // Caracteres lidos no token atual
+    uint8_t candidates;              // Cabeçalhos conhecidos que ainda casam com o nome lido
+    uint8_t header;                  // Cabeçalho cujo valor está sendo lido
+    char value[HTTP_VALUE_MAX + 1];  // Valor do cabeçalho atual
+    uint8_t value_len;               // Tamanho do valor atual
+    char method_buf[8];              // Método lido
+    bool line_empty;                 // Nenhum caractere na linha atual (fim dos cabeçalhos)
+} http_parser_t;
+
+void http_parser_init(http_parser_t *parser);                                 // Prepara o parser para uma nova requisição
+size_t http_parser_feed(http_parser_t *parser, const char *data, size_t len); // Consome bytes e retorna quantos foram usados
+
+#endif // HTTP_PARSER_H
@@ -0,0 +1,56 @@
+#include "http_router.h"
+
+// O caminho termina no fim da string ou no início da query string
+static bool is_path_end(char c)
+{
+    return c == '\0' || c == '?';
+}
+
+// Percorre a tabela comparando método e prefixo; o número da rota é extraído na mesma passada.
+// O custo depende apenas do tamanho da tabela e do caminho, não da quantidade de vagas.
+const http_route_t *http_route_match(const http_route_t *routes, size_t count,
+                                     http_method_t method, const char *path, int *id)
+{
+    for (size_t r = 0; r < count; r++)
+    {
+        const http_route_t *route = &routes[r];
+        if (route->method != method)
+            continue;
+
+        const char *p = path;
+        const char *prefix = route->prefix;
+        while (*prefix && *p == *prefix)
+        {
+            p++;
+            prefix++;
+        }
+        if (*prefix)
+            continue;
+
+        if (!route->has_id)
+        {
+            if (is_path_end(*p))
+            {
+                *id = 0;
+                return route;
+            }
+            continue;
+        }
+
+        // Número decimal de até 5 dígitos logo após o prefixo
+        int value = 0;
+        int digits = 0;
+        while (*p >= '0' && *p <= '9' && digits < 5)
+        {
+            value = value * 10 + (*p++ - '0');
+            digits++;
+        }
+        if (digits > 0 && is_path_end(*p))
+        {
+            *id = value;
+            return route;
+        }
+    }
+
+    return NULL;
+}
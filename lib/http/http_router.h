@@ -0,0 +1,23 @@
+#ifndef HTTP_ROUTER_H
+#define HTTP_ROUTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "http_parser.h"
+
+typedef void (*http_route_handler_t)(void *ctx, int id); // Tratador de rota: contexto da conexão e número extraído do caminho
+
+// Rota: método + prefixo do caminho, opcionalmente seguido de um número (ex.: "/reservar-vaga-" + "3")
+typedef struct http_route
+{
+    http_method_t method;         // Método aceito
+    const char *prefix;           // Caminho (ou prefixo, se has_id)
+    bool has_id;                  // O prefixo é seguido por um número decimal
+    http_route_handler_t handler; // Função chamada quando a rota casa
+} http_route_t;
+
+const http_route_t *http_route_match(const http_route_t *routes, size_t count,
+                                     http_method_t method, const char *path, int *id); // Encontra a rota da requisição
+
+#endif // HTTP_ROUTER_H
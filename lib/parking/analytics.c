@@ -0,0 +1,265 @@
+#include <string.h>
+
+#include "analytics.h"
+
+#define ANALYTICS_HOUR_MS 3600000u
+
+// 2^(-i/16) em Q16, i = 0..16
+static const uint32_t analytics_decay_table[17] = {
+    65536, 62757, 60097, 57549, 55109, 52773, 50535, 48393, 46341,
+    44376, 42495, 40693, 38968, 37316, 35734, 34219, 32768,
+};
+
+// Fator 2^(-dt/meia-vida) em Q16: meias-vidas inteiras por deslocamento, fração pela tabela com interpolação
+static uint32_t analytics_decay(uint32_t dt_ms, uint32_t half_life_ms)
+{
+    uint32_t halves = dt_ms / half_life_ms;
+    if (halves > 16)
+        return 0;
+
+    uint32_t pos = (uint32_t)(((uint64_t)(dt_ms % half_life_ms) << 12) / half_life_ms); // 0..4095
+    uint32_t a = analytics_decay_table[pos >> 8];
+    uint32_t b = analytics_decay_table[(pos >> 8) + 1];
+    return (a - (((a - b) * (pos & 0xFF)) >> 8)) >> halves;
+}
+
+// Média com decaimento exponencial: "busy" (Q16) valeu durante todo o intervalo dt
+static uint32_t analytics_blend(uint32_t value, uint32_t busy, uint32_t dt_ms, uint32_t half_life_ms)
+{
+    uint32_t decay = analytics_decay(dt_ms, half_life_ms);
+    return (uint32_t)(((uint64_t)value * decay + (uint64_t)busy * (ANALYTICS_ONE - decay)) >> 16);
+}
+
+// Tempo decorrido desde "since"; 0 se now_ms é anterior (instante lido antes de um evento concorrente)
+static inline uint32_t analytics_elapsed(uint32_t now_ms, uint32_t since_ms)
+{
+    return ((int32_t)(now_ms - since_ms) > 0) ? now_ms - since_ms : 0;
+}
+
+static inline uint16_t analytics_permille(uint32_t q16)
+{
+    return (uint16_t)(((uint64_t)q16 * 1000 + ANALYTICS_ONE / 2) >> 16);
+}
+
+static inline void analytics_inc16(uint16_t *counter)
+{
+    if (*counter != UINT16_MAX)
+        (*counter)++;
+}
+
+// Faixa do histograma: posição do bit mais alto dos segundos (0 s na faixa 0)
+static inline uint8_t analytics_bucket(uint32_t seconds)
+{
+    uint8_t bucket = seconds ? (uint8_t)(32 - __builtin_clz(seconds)) : 0;
+    return bucket < ANALYTICS_DWELL_BUCKETS ? bucket : ANALYTICS_DWELL_BUCKETS - 1;
+}
+
+static inline uint32_t analytics_zone_busy(const analytics_zone_t *zone)
+{
+    return zone->size ? (uint32_t)(((uint64_t)zone->occupied * ANALYTICS_ONE) / zone->size) : 0;
+}
+
+static inline analytics_hour_t *analytics_current(analytics_t *analytics)
+{
+    return &analytics->hours[analytics->hour % ANALYTICS_HOURS];
+}
+
+// Começa o resumo de uma nova hora, reaproveitando a posição de 24 horas atrás
+static void analytics_open_hour(analytics_t *analytics, uint32_t hour)
+{
+    analytics_hour_t *slot = &analytics->hours[hour % ANALYTICS_HOURS];
+    memset(slot, 0, sizeof(*slot));
+    slot->hour = hour;
+    slot->peak_occupied = analytics->occupied;
+    analytics->hour = hour;
+}
+
+void analytics_init(analytics_t *analytics, analytics_spot_t *spots, uint16_t size,
+                    analytics_zone_t *zones, uint8_t zone_count, uint32_t half_life_ms, uint32_t now_ms)
+{
+    analytics->spots = spots;
+    analytics->size = size;
+    analytics->zones = zones;
+    analytics->zone_count = zone_count;
+    analytics->half_life_ms = half_life_ms;
+    analytics->occupied = 0;
+
+    memset(spots, 0, size * sizeof(*spots));
+    memset(zones, 0, zone_count * sizeof(*zones));
+    for (uint8_t z = 0; z < zone_count; z++)
+        zones[z].updated_ms = now_ms;
+
+    for (int h = 0; h < ANALYTICS_HOURS; h++)
+        analytics->hours[h].hour = UINT32_MAX; // Posição ainda não usada
+    analytics_open_hour(analytics, now_ms / ANALYTICS_HOUR_MS);
+    analytics->updated_ms = now_ms;
+}
+
+// Registra a zona e o status inicial da vaga; deve ser chamada uma vez por vaga após analytics_init
+void analytics_seed(analytics_t *analytics, uint16_t spot, uint8_t zone, parking_status_t status, uint32_t now_ms)
+{
+    analytics_spot_t *entry = &analytics->spots[spot];
+    entry->zone = zone;
+    entry->status = status;
+    entry->entered_ms = now_ms;
+    entry->utilization = (status == PARKING_OCCUPIED) ? ANALYTICS_ONE : 0;
+
+    analytics->zones[zone].size++;
+    if (status == PARKING_OCCUPIED)
+    {
+        analytics->zones[zone].occupied++;
+        analytics->occupied++;
+        if (analytics->occupied > analytics_current(analytics)->peak_occupied)
+            analytics_current(analytics)->peak_occupied = analytics->occupied;
+    }
+}
+
+// Integra a ocupação até now_ms, fechando as horas que terminaram no caminho. Sem eventos por mais de
+// um anel inteiro, as horas intermediárias são iguais e o laço começa direto na mais antiga que cabe.
+void analytics_advance(analytics_t *analytics, uint32_t now_ms)
+{
+    uint32_t hour = now_ms / ANALYTICS_HOUR_MS;
+
+    if ((int32_t)(now_ms - analytics->updated_ms) < 0)
+        return; // Instante anterior ao já integrado (lido antes de um evento concorrente)
+
+    // O contador de ms deu a volta (~49 dias): recomeça o anel
+    if (hour < analytics->hour)
+    {
+        analytics_open_hour(analytics, hour);
+        analytics->updated_ms = now_ms;
+        return;
+    }
+
+    if (hour - analytics->hour > ANALYTICS_HOURS)
+    {
+        analytics_open_hour(analytics, hour - ANALYTICS_HOURS);
+        analytics->updated_ms = analytics->hour * ANALYTICS_HOUR_MS;
+    }
+
+    while (analytics->hour != hour)
+    {
+        uint32_t elapsed = analytics->updated_ms - analytics->hour * ANALYTICS_HOUR_MS;
+        analytics_current(analytics)->occupied_spot_ms += (uint64_t)analytics->occupied * (ANALYTICS_HOUR_MS - elapsed);
+        analytics_open_hour(analytics, analytics->hour + 1);
+        analytics->updated_ms = analytics->hour * ANALYTICS_HOUR_MS;
+    }
+
+    analytics_current(analytics)->occupied_spot_ms += (uint64_t)analytics->occupied * (now_ms - analytics->updated_ms);
+    analytics->updated_ms = now_ms;
+}
+
+// Contabiliza a transição da vaga para "to". O status de origem é o último registrado aqui, então
+// eventos de tarefas concorrentes sempre formam uma sequência válida para a vaga.
+void analytics_record(analytics_t *analytics, uint16_t spot, parking_status_t to, uint32_t now_ms)
+{
+    analytics_spot_t *entry = &analytics->spots[spot];
+    analytics_zone_t *zone = &analytics->zones[entry->zone];
+    parking_status_t from = (parking_status_t)entry->status;
+
+    if (from == to)
+        return;
+
+    // Eventos concorrentes podem chegar com instantes fora de ordem: o tempo nunca volta
+    analytics_advance(analytics, now_ms);
+    now_ms = analytics->updated_ms;
+    uint32_t dwell_ms = analytics_elapsed(now_ms, entry->entered_ms);
+    analytics_hour_t *hour = analytics_current(analytics);
+
+    // Utilizações com o status que valeu até agora
+    entry->utilization = analytics_blend(entry->utilization, (from == PARKING_OCCUPIED) ? ANALYTICS_ONE : 0,
+                                         dwell_ms, analytics->half_life_ms);
+    zone->utilization = analytics_blend(zone->utilization, analytics_zone_busy(zone),
+                                        analytics_elapsed(now_ms, zone->updated_ms), analytics->half_life_ms);
+    zone->updated_ms = now_ms;
+
+    if (from == PARKING_OCCUPIED)
+    {
+        uint32_t dwell_s = dwell_ms / 1000;
+        entry->dwell_sum_s += dwell_s;
+        analytics_inc16(&entry->sessions);
+        analytics_inc16(&zone->dwell_hist[analytics_bucket(dwell_s)]);
+        zone->dwell_sum_s += dwell_s;
+        zone->sessions++;
+        zone->occupied--;
+        analytics->occupied--;
+        analytics_inc16(&hour->departures);
+    }
+    else if (from == PARKING_RESERVED)
+    {
+        if (to == PARKING_OCCUPIED)
+            zone->fulfilled++;
+        else
+        {
+            zone->no_shows++;
+            analytics_inc16(&hour->no_shows);
+        }
+    }
+
+    if (to == PARKING_OCCUPIED)
+    {
+        zone->occupied++;
+        analytics->occupied++;
+        analytics_inc16(&hour->arrivals);
+        if (analytics->occupied > hour->peak_occupied)
+            hour->peak_occupied = analytics->occupied;
+    }
+    else if (to == PARKING_RESERVED)
+    {
+        zone->reservations++;
+        analytics_inc16(&hour->reservations);
+    }
+
+    entry->status = to;
+    entry->entered_ms = now_ms;
+}
+
+// Utilização da vaga até now_ms, em partes por mil
+uint16_t analytics_spot_utilization(const analytics_t *analytics, uint16_t spot, uint32_t now_ms)
+{
+    const analytics_spot_t *entry = &analytics->spots[spot];
+    uint32_t busy = (entry->status == PARKING_OCCUPIED) ? ANALYTICS_ONE : 0;
+    return analytics_permille(analytics_blend(entry->utilization, busy, analytics_elapsed(now_ms, entry->entered_ms),
+                                              analytics->half_life_ms));
+}
+
+// Utilização da zona (fração de vagas ocupadas) até now_ms, em partes por mil
+uint16_t analytics_zone_utilization(const analytics_t *analytics, uint8_t zone, uint32_t now_ms)
+{
+    const analytics_zone_t *entry = &analytics->zones[zone];
+    return analytics_permille(analytics_blend(entry->utilization, analytics_zone_busy(entry),
+                                              analytics_elapsed(now_ms, entry->updated_ms), analytics->half_life_ms));
+}
+
+// Permanência média na vaga (s), 0 sem permanências concluídas
+uint32_t analytics_spot_mean_dwell_s(const analytics_t *analytics, uint16_t spot)
+{
+    const analytics_spot_t *entry = &analytics->spots[spot];
+    return entry->sessions ? entry->dwell_sum_s / entry->sessions : 0;
+}
+
+// Permanência média na zona (s), 0 sem permanências concluídas
+uint32_t analytics_zone_mean_dwell_s(const analytics_t *analytics, uint8_t zone)
+{
+    const analytics_zone_t *entry = &analytics->zones[zone];
+    return entry->sessions ? entry->dwell_sum_s / entry->sessions : 0;
+}
+
+// Reservas liberadas sem ocupação, em partes por mil das reservas já encerradas
+uint16_t analytics_zone_no_show(const analytics_t *analytics, uint8_t zone)
+{
+    const analytics_zone_t *entry = &analytics->zones[zone];
+    uint32_t closed = entry->fulfilled + entry->no_shows;
+    return closed ? (uint16_t)(((uint64_t)entry->no_shows * 1000) / closed) : 0;
+}
+
+// Resumo de "age" horas atrás (0 é a hora corrente); NULL se a hora não está no anel
+const analytics_hour_t *analytics_hour_at(const analytics_t *analytics, uint8_t age)
+{
+    if (age >= ANALYTICS_HOURS || age > analytics->hour)
+        return NULL;
+
+    uint32_t hour = analytics->hour - age;
+    const analytics_hour_t *slot = &analytics->hours[hour % ANALYTICS_HOURS];
+    return (slot->hour == hour) ? slot : NULL;
+}
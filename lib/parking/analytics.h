@@ -0,0 +1,79 @@
+#ifndef ANALYTICS_H
+#define ANALYTICS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "parking.h"
+
+#define ANALYTICS_DWELL_BUCKETS 16 // Faixas do histograma: 0 s, 1 s, 2-3 s, 4-7 s, ... e >= 2^14 s
+#define ANALYTICS_HOURS 24         // Horas guardadas no anel de resumos horários
+#define ANALYTICS_ONE 65536u       // 1.0 em ponto fixo Q16 (utilização)
+
+// Estatísticas de uma vaga
+typedef struct analytics_spot
+{
+    uint32_t entered_ms;  // Instante em que a vaga entrou no status atual
+    uint32_t dwell_sum_s; // Soma das permanências concluídas (s)
+    uint32_t utilization; // Fração do tempo ocupada com decaimento exponencial (Q16)
+    uint16_t sessions;    // Permanências concluídas (ocupada -> livre)
+    uint8_t status;       // Status atual (parking_status_t)
+    uint8_t zone;         // Zona da vaga
+} analytics_spot_t;
+
+// Estatísticas de uma zona
+typedef struct analytics_zone
+{
+    uint16_t dwell_hist[ANALYTICS_DWELL_BUCKETS]; // Permanências por faixa log2 de segundos
+    uint32_t dwell_sum_s;                         // Soma das permanências concluídas (s)
+    uint32_t sessions;                            // Permanências concluídas
+    uint32_t reservations;                        // Reservas feitas
+    uint32_t fulfilled;                           // Reservas que viraram ocupação
+    uint32_t no_shows;                            // Reservas liberadas sem ocupação (expiradas ou canceladas)
+    uint32_t utilization;                         // Fração de vagas ocupadas com decaimento exponencial (Q16)
+    uint32_t updated_ms;                          // Instante da última atualização da utilização
+    uint16_t size;                                // Vagas da zona
+    uint16_t occupied;                            // Vagas ocupadas agora
+} analytics_zone_t;
+
+// Resumo de uma hora (contada desde o boot)
+typedef struct analytics_hour
+{
+    uint32_t hour;             // Hora do resumo (now_ms / 3600000)
+    uint64_t occupied_spot_ms; // Integral de vagas ocupadas no tempo (vagas x ms)
+    uint16_t arrivals;         // Vagas que passaram a ocupadas
+    uint16_t departures;       // Vagas ocupadas que foram liberadas
+    uint16_t reservations;     // Reservas feitas
+    uint16_t no_shows;         // Reservas liberadas sem ocupação
+    uint16_t peak_occupied;    // Maior quantidade de vagas ocupadas ao mesmo tempo
+} analytics_hour_t;
+
+// Motor de estatísticas alimentado pelas transições. Memória fixa (por vaga, por zona e 24 horas) e
+// custo O(1) por evento, para rodar no próprio caminho da transição. Não é thread-safe: o chamador
+// serializa as chamadas (seção crítica curta).
+typedef struct analytics
+{
+    analytics_spot_t *spots;                 // Uma entrada por vaga (buffer do chamador)
+    uint16_t size;                           // Quantidade de vagas
+    analytics_zone_t *zones;                 // Uma entrada por zona (buffer do chamador)
+    uint8_t zone_count;                      // Quantidade de zonas
+    uint32_t half_life_ms;                   // Meia-vida do decaimento da utilização
+    analytics_hour_t hours[ANALYTICS_HOURS]; // Anel de resumos horários
+    uint32_t hour;                           // Hora corrente
+    uint32_t updated_ms;                     // Instante até o qual a hora corrente foi integrada
+    uint16_t occupied;                       // Vagas ocupadas agora
+} analytics_t;
+
+void analytics_init(analytics_t *analytics, analytics_spot_t *spots, uint16_t size,
+                    analytics_zone_t *zones, uint8_t zone_count, uint32_t half_life_ms, uint32_t now_ms); // Zera as estatísticas
+void analytics_seed(analytics_t *analytics, uint16_t spot, uint8_t zone, parking_status_t status, uint32_t now_ms); // Define zona e status inicial da vaga (sem contar evento)
+void analytics_record(analytics_t *analytics, uint16_t spot, parking_status_t to, uint32_t now_ms); // Contabiliza a transição da vaga para "to"
+void analytics_advance(analytics_t *analytics, uint32_t now_ms);                                  // Fecha as horas que já passaram
+uint16_t analytics_spot_utilization(const analytics_t *analytics, uint16_t spot, uint32_t now_ms); // Utilização da vaga (por mil)
+uint16_t analytics_zone_utilization(const analytics_t *analytics, uint8_t zone, uint32_t now_ms);  // Utilização da zona (por mil)
+uint32_t analytics_spot_mean_dwell_s(const analytics_t *analytics, uint16_t spot);                // Permanência média na vaga (s)
+uint32_t analytics_zone_mean_dwell_s(const analytics_t *analytics, uint8_t zone);                 // Permanência média na zona (s)
+uint16_t analytics_zone_no_show(const analytics_t *analytics, uint8_t zone);                      // Reservas sem ocupação (por mil das reservas encerradas)
+const analytics_hour_t *analytics_hour_at(const analytics_t *analytics, uint8_t age);             // Resumo de "age" horas atrás (NULL se não existe)
+
+#endif // ANALYTICS_H
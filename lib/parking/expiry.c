@@ -0,0 +1,134 @@
+#include "expiry.h"
+
+// Compara prazos considerando o estouro do contador de ms (válido para diferenças < 24 dias)
+static inline bool expiry_before(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) < 0;
+}
+
+static inline void expiry_place(expiry_heap_t *expiry, uint16_t slot, uint16_t id)
+{
+    expiry->heap[slot] = id;
+    expiry->pos[id] = slot + 1;
+}
+
+static void expiry_sift_up(expiry_heap_t *expiry, uint16_t slot)
+{
+    uint16_t id = expiry->heap[slot];
+    uint32_t deadline = expiry->deadline[id];
+
+    while (slot > 0)
+    {
+        uint16_t parent = (slot - 1) / 2;
+        if (!expiry_before(deadline, expiry->deadline[expiry->heap[parent]]))
+            break;
+        expiry_place(expiry, slot, expiry->heap[parent]);
+        slot = parent;
+    }
+    expiry_place(expiry, slot, id);
+}
+
+static void expiry_sift_down(expiry_heap_t *expiry, uint16_t slot)
+{
+    uint16_t id = expiry->heap[slot];
+    uint32_t deadline = expiry->deadline[id];
+
+    while (1)
+    {
+        uint32_t child = 2 * (uint32_t)slot + 1;
+        if (child >= expiry->count)
+            break;
+        if (child + 1 < expiry->count &&
+            expiry_before(expiry->deadline[expiry->heap[child + 1]], expiry->deadline[expiry->heap[child]]))
+            child++;
+        if (!expiry_before(expiry->deadline[expiry->heap[child]], deadline))
+            break;
+        expiry_place(expiry, slot, expiry->heap[child]);
+        slot = child;
+    }
+    expiry_place(expiry, slot, id);
+}
+
+// Remove o item da posição indicada, preenchendo o buraco com o último item do heap
+static void expiry_remove_at(expiry_heap_t *expiry, uint16_t slot)
+{
+    uint16_t id = expiry->heap[slot];
+    expiry->pos[id] = 0;
+    expiry->count--;
+
+    if (slot == expiry->count)
+        return;
+
+    uint16_t last = expiry->heap[expiry->count];
+    expiry_place(expiry, slot, last);
+    if (slot > 0 && expiry_before(expiry->deadline[last], expiry->deadline[expiry->heap[(slot - 1) / 2]]))
+        expiry_sift_up(expiry, slot);
+    else
+        expiry_sift_down(expiry, slot);
+}
+
+// Inicializa a fila sem nenhum prazo agendado
+void expiry_init(expiry_heap_t *expiry, uint16_t *heap, uint16_t *pos, uint32_t *deadline, uint16_t capacity)
+{
+    expiry->heap = heap;
+    expiry->pos = pos;
+    expiry->deadline = deadline;
+    expiry->capacity = capacity;
+    expiry->count = 0;
+
+    for (uint16_t i = 0; i < capacity; i++)
+        pos[i] = 0;
+}
+
+// Agenda o prazo de uma vaga; se ela já tinha um prazo, ele é substituído
+void expiry_schedule(expiry_heap_t *expiry, uint16_t id, uint32_t deadline_ms)
+{
+    if (id >= expiry->capacity)
+        return;
+
+    if (expiry->pos[id])
+    {
+        uint16_t slot = expiry->pos[id] - 1;
+        bool earlier = expiry_before(deadline_ms, expiry->deadline[id]);
+        expiry->deadline[id] = deadline_ms;
+        if (earlier)
+            expiry_sift_up(expiry, slot);
+        else
+            expiry_sift_down(expiry, slot);
+        return;
+    }
+
+    expiry->deadline[id] = deadline_ms;
+    expiry_place(expiry, expiry->count, id);
+    expiry->count++;
+    expiry_sift_up(expiry, expiry->count - 1);
+}
+
+// Remove o prazo de uma vaga, se houver
+void expiry_cancel(expiry_heap_t *expiry, uint16_t id)
+{
+    if (id < expiry->capacity && expiry->pos[id])
+        expiry_remove_at(expiry, expiry->pos[id] - 1);
+}
+
+// Consulta o prazo mais próximo sem removê-lo
+bool expiry_next(const expiry_heap_t *expiry, uint16_t *id, uint32_t *deadline_ms)
+{
+    if (expiry->count == 0)
+        return false;
+
+    *id = expiry->heap[0];
+    *deadline_ms = expiry->deadline[*id];
+    return true;
+}
+
+// Remove e retorna uma vaga cujo prazo já venceu em now_ms
+bool expiry_pop_due(expiry_heap_t *expiry, uint32_t now_ms, uint16_t *id)
+{
+    if (expiry->count == 0 || expiry_before(now_ms, expiry->deadline[expiry->heap[0]]))
+        return false;
+
+    *id = expiry->heap[0];
+    expiry_remove_at(expiry, 0);
+    return true;
+}
@@ -0,0 +1,25 @@
+#ifndef EXPIRY_H
+#define EXPIRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Fila de prazos indexada (min-heap): cada vaga tem no máximo um prazo agendado, que pode ser
+// reagendado ou cancelado em O(log n). O próximo prazo é consultado em O(1), de modo que a
+// tarefa de expiração dorme exatamente até ele, sem percorrer as vagas.
+typedef struct expiry_heap
+{
+    uint16_t *heap;      // Vagas ordenadas pelo prazo (heap binário)
+    uint16_t *pos;       // Posição de cada vaga no heap + 1 (0 = sem prazo agendado)
+    uint32_t *deadline;  // Prazo de cada vaga em ms desde o boot
+    uint16_t capacity;   // Quantidade de vagas
+    uint16_t count;      // Prazos agendados
+} expiry_heap_t;
+
+void expiry_init(expiry_heap_t *expiry, uint16_t *heap, uint16_t *pos, uint32_t *deadline, uint16_t capacity); // Inicializa sem prazos
+void expiry_schedule(expiry_heap_t *expiry, uint16_t id, uint32_t deadline_ms);                                // Agenda ou reagenda o prazo de uma vaga
+void expiry_cancel(expiry_heap_t *expiry, uint16_t id);                                                        // Remove o prazo de uma vaga
+bool expiry_next(const expiry_heap_t *expiry, uint16_t *id, uint32_t *deadline_ms);                            // Consulta o próximo prazo
+bool expiry_pop_due(expiry_heap_t *expiry, uint32_t now_ms, uint16_t *id);                                     // Remove um prazo já vencido
+
+#endif // EXPIRY_H
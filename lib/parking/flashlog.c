@@ -0,0 +1,301 @@
+#include <string.h>
+
+#include "flashlog.h"
+
+// Cabeçalho no início de cada setor, seguido do status de cada vaga
+typedef struct flashlog_header
+{
+    uint32_t magic;      // FLASHLOG_MAGIC
+    uint32_t generation; // Geração do setor
+    uint32_t base_seq;   // Sequência do primeiro registro do setor
+    uint16_t size;       // Quantidade de vagas da cópia do estado
+    uint16_t reserved;   // 0xFFFF
+    uint32_t crc;        // CRC-32 dos campos acima e da cópia do estado
+} flashlog_header_t;
+
+// Registro de transição: sequência (4 bytes), vaga (2), novo status (1) e CRC-8 dos 7 bytes anteriores
+typedef struct flashlog_record
+{
+    uint32_t seq;
+    uint16_t index;
+    uint8_t status;
+    uint8_t check;
+} flashlog_record_t;
+
+static uint32_t flashlog_crc32(uint32_t crc, const void *data, size_t len)
+{
+    const uint8_t *bytes = data;
+    crc = ~crc;
+    while (len--)
+    {
+        crc ^= *bytes++;
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1));
+    }
+    return ~crc;
+}
+
+static uint8_t flashlog_crc8(const void *data, size_t len)
+{
+    const uint8_t *bytes = data;
+    uint8_t crc = 0;
+    while (len--)
+    {
+        crc ^= *bytes++;
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+// CRC-8 do registro. O valor 0xFF nunca é usado, então um registro cujo último byte não chegou a
+// ser programado nunca parece válido, qualquer que seja o conteúdo dos bytes anteriores.
+static uint8_t flashlog_record_check(const flashlog_record_t *record)
+{
+    uint8_t check = flashlog_crc8(record, offsetof(flashlog_record_t, check));
+    return (check == 0xFF) ? 0x00 : check;
+}
+
+// Compara gerações considerando o estouro do contador
+static inline bool flashlog_newer(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) > 0;
+}
+
+// Primeiro registro do setor: logo após a página que termina a cópia do estado
+static inline uint32_t flashlog_records_start(const flashlog_t *log)
+{
+    uint32_t image = sizeof(flashlog_header_t) + log->size;
+    return (image + FLASHLOG_PAGE_SIZE - 1) & ~(uint32_t)(FLASHLOG_PAGE_SIZE - 1);
+}
+
+static uint32_t flashlog_header_crc(const flashlog_header_t *header, const uint8_t *state)
+{
+    uint32_t crc = flashlog_crc32(0, header, offsetof(flashlog_header_t, crc));
+    return flashlog_crc32(crc, state, header->size);
+}
+
+// Lê o cabeçalho e a cópia do estado de um setor para log->state; falso se o setor não é válido
+static bool flashlog_load_sector(flashlog_t *log, uint32_t sector, flashlog_header_t *header)
+{
+    uint32_t base = sector * FLASHLOG_SECTOR_SIZE;
+
+    if (!log->io->read(log->io->ctx, base, header, sizeof(*header)))
+        return false;
+    if (header->magic != FLASHLOG_MAGIC || header->size != log->size)
+        return false;
+    if (!log->io->read(log->io->ctx, base + sizeof(*header), log->state, log->size))
+        return false;
+
+    return flashlog_header_crc(header, log->state) == header->crc;
+}
+
+// Monta uma página da imagem inicial do setor (cabeçalho + estado); o cabeçalho fica em 0xFF se header == NULL
+static void flashlog_image_page(const flashlog_t *log, uint32_t page_offset, const flashlog_header_t *header, uint8_t *page)
+{
+    memset(page, 0xFF, FLASHLOG_PAGE_SIZE);
+
+    for (uint32_t i = 0; i < FLASHLOG_PAGE_SIZE; i++)
+    {
+        uint32_t pos = page_offset + i;
+        if (pos < sizeof(flashlog_header_t))
+        {
+            if (header)
+                page[i] = ((const uint8_t *)header)[pos];
+        }
+        else if (pos < sizeof(flashlog_header_t) + log->size)
+            page[i] = log->state[pos - sizeof(flashlog_header_t)];
+        else
+            break;
+    }
+}
+
+void flashlog_init(flashlog_t *log, const flashlog_io_t *io, uint32_t sectors, uint8_t *state, uint16_t size)
+{
+    log->io = io;
+    log->sectors = sectors;
+    log->state = state;
+    log->size = size;
+    log->generation = 0;
+    log->sector = sectors - 1; // A primeira compactação usa o setor 0
+    log->offset = FLASHLOG_SECTOR_SIZE;
+    log->next_seq = 0;
+    memset(log->page, 0xFF, sizeof(log->page));
+    log->page_dirty = false;
+}
+
+bool flashlog_mount(flashlog_t *log)
+{
+    flashlog_header_t header;
+    flashlog_header_t best_header;
+    int32_t best = -1;
+
+    // O setor válido de maior geração tem a cópia mais recente do estado
+    for (uint32_t s = 0; s < log->sectors; s++)
+    {
+        if (!flashlog_load_sector(log, s, &header))
+            continue;
+        if (best < 0 || flashlog_newer(header.generation, best_header.generation))
+        {
+            best = (int32_t)s;
+            best_header = header;
+        }
+    }
+
+    if (best < 0 || !flashlog_load_sector(log, (uint32_t)best, &best_header))
+    {
+        // Região vazia ou corrompida: começa com todas as vagas em 0 e formata
+        memset(log->state, 0, log->size);
+        log->generation = 0;
+        log->sector = log->sectors - 1;
+        flashlog_compact(log);
+        return false;
+    }
+
+    log->generation = best_header.generation;
+    log->sector = (uint32_t)best;
+    log->next_seq = best_header.base_seq;
+    log->offset = flashlog_records_start(log);
+
+    // Reaplica os registros até o primeiro espaço apagado. Um registro inválido é o final de uma
+    // escrita interrompida; nada é gravado depois dele, então o estado vai para um setor novo.
+    uint32_t base = log->sector * FLASHLOG_SECTOR_SIZE;
+    bool torn = false;
+
+    while (log->offset + FLASHLOG_RECORD_SIZE <= FLASHLOG_SECTOR_SIZE)
+    {
+        flashlog_record_t record;
+        static const uint8_t erased[FLASHLOG_RECORD_SIZE] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+        if (!log->io->read(log->io->ctx, base + log->offset, &record, sizeof(record)))
+        {
+            torn = true;
+            break;
+        }
+        if (memcmp(&record, erased, sizeof(record)) == 0)
+            break;
+        if (record.check != flashlog_record_check(&record) ||
+            record.seq != log->next_seq || record.index >= log->size)
+        {
+            torn = true;
+            break;
+        }
+
+        log->state[record.index] = record.status;
+        log->next_seq++;
+        log->offset += FLASHLOG_RECORD_SIZE;
+    }
+
+    if (torn || log->offset + FLASHLOG_RECORD_SIZE > FLASHLOG_SECTOR_SIZE)
+    {
+        flashlog_compact(log);
+        return true;
+    }
+
+    // Carrega a página parcialmente escrita para que a próxima programação repita os bytes já gravados
+    memset(log->page, 0xFF, sizeof(log->page));
+    uint32_t page_base = log->offset & ~(uint32_t)(FLASHLOG_PAGE_SIZE - 1);
+    if (page_base != log->offset)
+        log->io->read(log->io->ctx, base + page_base, log->page, log->offset - page_base);
+    log->page_dirty = false;
+
+    return true;
+}
+
+bool flashlog_append(flashlog_t *log, uint16_t index, uint8_t status)
+{
+    if (index >= log->size)
+        return false;
+
+    // Setor cheio: o estado atual (sem este registro) vai para o próximo setor
+    if (log->offset + FLASHLOG_RECORD_SIZE > FLASHLOG_SECTOR_SIZE && !flashlog_compact(log))
+        return false;
+
+    flashlog_record_t record = {
+        .seq = log->next_seq,
+        .index = index,
+        .status = status,
+    };
+    record.check = flashlog_record_check(&record);
+
+    memcpy(&log->page[log->offset % FLASHLOG_PAGE_SIZE], &record, sizeof(record));
+    log->page_dirty = true;
+    log->state[index] = status;
+    log->offset += FLASHLOG_RECORD_SIZE;
+    log->next_seq++;
+
+    // Página completa: programa agora, pois o próximo registro já cai na página seguinte
+    if (log->offset % FLASHLOG_PAGE_SIZE == 0)
+    {
+        bool ok = flashlog_flush(log);
+        memset(log->page, 0xFF, sizeof(log->page));
+        log->page_dirty = false;
+        if (!ok)
+            log->offset = FLASHLOG_SECTOR_SIZE; // Força uma compactação, que grava o estado completo
+        return ok;
+    }
+    return true;
+}
+
+bool flashlog_flush(flashlog_t *log)
+{
+    if (!log->page_dirty)
+        return true;
+
+    uint32_t page_base = (log->offset - 1) & ~(uint32_t)(FLASHLOG_PAGE_SIZE - 1);
+    if (!log->io->program(log->io->ctx, log->sector * FLASHLOG_SECTOR_SIZE + page_base, log->page, FLASHLOG_PAGE_SIZE))
+        return false;
+
+    log->page_dirty = false;
+    return true;
+}
+
+bool flashlog_compact(flashlog_t *log)
+{
+    uint32_t target = (log->sector + 1) % log->sectors;
+    uint32_t base = target * FLASHLOG_SECTOR_SIZE;
+    uint32_t records_start = flashlog_records_start(log);
+
+    if (records_start + FLASHLOG_RECORD_SIZE > FLASHLOG_SECTOR_SIZE)
+        return false;
+
+    flashlog_header_t header = {
+        .magic = FLASHLOG_MAGIC,
+        .generation = log->generation + 1,
+        .base_seq = log->next_seq,
+        .size = log->size,
+        .reserved = 0xFFFF,
+    };
+    header.crc = flashlog_header_crc(&header, log->state);
+
+    // A página em escrita é descartada: os registros pendentes já estão em log->state. Se a
+    // compactação falhar, o setor atual fica como cheio e a próxima escrita tenta de novo.
+    log->offset = FLASHLOG_SECTOR_SIZE;
+    log->page_dirty = false;
+
+    if (!log->io->erase(log->io->ctx, base))
+        return false;
+
+    // Cópia do estado primeiro e cabeçalho por último: sem cabeçalho o setor é ignorado na recuperação
+    for (uint32_t page_offset = 0; page_offset < records_start; page_offset += FLASHLOG_PAGE_SIZE)
+    {
+        flashlog_image_page(log, page_offset, NULL, log->page);
+        if (!log->io->program(log->io->ctx, base + page_offset, log->page, FLASHLOG_PAGE_SIZE))
+            return false;
+    }
+
+    flashlog_image_page(log, 0, &header, log->page);
+    if (!log->io->program(log->io->ctx, base, log->page, FLASHLOG_PAGE_SIZE))
+        return false;
+
+    log->generation = header.generation;
+    log->sector = target;
+    log->offset = records_start;
+    memset(log->page, 0xFF, sizeof(log->page));
+    return true;
+}
+
+bool flashlog_pending(const flashlog_t *log)
+{
+    return log->page_dirty;
+}
@@ -0,0 +1,49 @@
+#ifndef FLASHLOG_H
+#define FLASHLOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define FLASHLOG_PAGE_SIZE 256    // Menor unidade de programação da flash
+#define FLASHLOG_SECTOR_SIZE 4096 // Menor unidade de apagamento da flash
+#define FLASHLOG_RECORD_SIZE 8    // Tamanho de um registro de transição
+#define FLASHLOG_MAGIC 0x474C4B50 // "PKLG"
+
+// Acesso à flash. Offsets são relativos ao início da região do log; program recebe sempre uma página
+// inteira alinhada e erase um setor alinhado. A flash só muda bits de 1 para 0 ao programar, então
+// reprogramar uma página com os mesmos bytes (e 0xFF no que ainda não foi escrito) é inofensivo.
+typedef struct flashlog_io
+{
+    void *ctx;                                                                // Contexto do backend
+    bool (*read)(void *ctx, uint32_t offset, void *dst, size_t len);          // Lê bytes da região
+    bool (*program)(void *ctx, uint32_t offset, const void *src, size_t len); // Programa uma página
+    bool (*erase)(void *ctx, uint32_t offset);                                // Apaga um setor
+} flashlog_io_t;
+
+// Log estruturado em setores usados em rodízio. Cada setor começa com uma cópia completa do estado
+// (cabeçalho + status de cada vaga) seguida de registros de 8 bytes com as transições posteriores.
+// Quando o setor enche, o estado é compactado no próximo setor, que é o mais antigo; o cabeçalho é
+// gravado por último, então um corte de energia no meio da compactação mantém o setor anterior válido.
+typedef struct flashlog
+{
+    const flashlog_io_t *io;          // Backend de acesso à flash
+    uint32_t sectors;                 // Quantidade de setores da região (>= 2)
+    uint8_t *state;                   // Status persistido de cada vaga (buffer do chamador)
+    uint16_t size;                    // Quantidade de vagas
+    uint32_t generation;              // Geração do setor atual (cresce a cada compactação)
+    uint32_t sector;                  // Setor atual
+    uint32_t offset;                  // Próximo registro dentro do setor atual
+    uint32_t next_seq;                // Sequência do próximo registro
+    uint8_t page[FLASHLOG_PAGE_SIZE]; // Cópia da página em escrita
+    bool page_dirty;                  // A página tem registros ainda não programados
+} flashlog_t;
+
+void flashlog_init(flashlog_t *log, const flashlog_io_t *io, uint32_t sectors, uint8_t *state, uint16_t size); // Prepara o log (sem acessar a flash)
+bool flashlog_mount(flashlog_t *log);                                     // Recupera o estado da flash; formata a região se não houver estado válido
+bool flashlog_append(flashlog_t *log, uint16_t index, uint8_t status);   // Registra uma transição (programa só quando a página enche)
+bool flashlog_flush(flashlog_t *log);                                     // Programa a página pendente
+bool flashlog_compact(flashlog_t *log);                                   // Grava o estado atual em um setor novo
+bool flashlog_pending(const flashlog_t *log);                             // Indica se há registros ainda não programados
+
+#endif // FLASHLOG_H
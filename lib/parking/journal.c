@@ -0,0 +1,80 @@
+#include "journal.h"
+
+// Inicializa o diário vazio
+void journal_init(journal_t *journal, journal_slot_t *slots, uint16_t capacity)
+{
+    journal->slots = slots;
+    journal->capacity = capacity;
+    atomic_init(&journal->head, 0);
+
+    for (uint16_t i = 0; i < capacity; i++)
+    {
+        atomic_init(&slots[i].stamp, 0);
+        atomic_init(&slots[i].timestamp, 0);
+        atomic_init(&slots[i].packed, 0);
+    }
+}
+
+// Registra uma transição. Nunca bloqueia: quando o anel está cheio o registro mais antigo é sobrescrito.
+uint32_t journal_append(journal_t *journal, uint32_t timestamp_ms, uint16_t spot,
+                        uint8_t old_status, uint8_t new_status, uint8_t source)
+{
+    uint32_t seq = atomic_fetch_add_explicit(&journal->head, 1, memory_order_relaxed);
+    journal_slot_t *slot = &journal->slots[seq & (journal->capacity - 1)];
+
+    atomic_store_explicit(&slot->stamp, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    atomic_store_explicit(&slot->timestamp, timestamp_ms, memory_order_relaxed);
+    atomic_store_explicit(&slot->packed,
+                          (uint32_t)spot | ((uint32_t)(old_status & 0x3) << 16) |
+                              ((uint32_t)(new_status & 0x3) << 18) | ((uint32_t)(source & 0xF) << 20),
+                          memory_order_relaxed);
+
+    atomic_store_explicit(&slot->stamp, seq + 1, memory_order_release);
+    return seq;
+}
+
+// Próxima sequência a ser escrita
+uint32_t journal_head(const journal_t *journal)
+{
+    return atomic_load_explicit(&journal->head, memory_order_acquire);
+}
+
+// Sequência mais antiga que ainda pode estar no anel
+uint32_t journal_oldest(const journal_t *journal)
+{
+    uint32_t head = journal_head(journal);
+    return (head > journal->capacity) ? head - journal->capacity : 0;
+}
+
+// Lê o registro de uma sequência sem bloquear os escritores
+journal_result_t journal_read(const journal_t *journal, uint32_t seq, journal_record_t *record)
+{
+    uint32_t head = journal_head(journal);
+    if ((int32_t)(seq - head) >= 0)
+        return JOURNAL_PENDING;
+    if (head - seq > journal->capacity)
+        return JOURNAL_LOST;
+
+    const journal_slot_t *slot = &journal->slots[seq & (journal->capacity - 1)];
+    uint32_t stamp = atomic_load_explicit(&slot->stamp, memory_order_acquire);
+    if (stamp != seq + 1)
+        return (stamp != 0 && (int32_t)(stamp - 1 - seq) > 0) ? JOURNAL_LOST : JOURNAL_PENDING;
+
+    uint32_t timestamp = atomic_load_explicit(&slot->timestamp, memory_order_relaxed);
+    uint32_t packed = atomic_load_explicit(&slot->packed, memory_order_relaxed);
+
+    // Confere se nenhum escritor reutilizou a posição durante a cópia
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit(&slot->stamp, memory_order_relaxed) != stamp)
+        return JOURNAL_LOST;
+
+    record->seq = seq;
+    record->timestamp_ms = timestamp;
+    record->spot = packed & 0xFFFF;
+    record->old_status = (packed >> 16) & 0x3;
+    record->new_status = (packed >> 18) & 0x3;
+    record->source = (packed >> 20) & 0xF;
+    return JOURNAL_OK;
+}
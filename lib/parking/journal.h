@@ -0,0 +1,61 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+// Origem de uma transição registrada no diário
+typedef enum journal_source
+{
+    JOURNAL_SOURCE_BUTTON = 0,    // Botão do joystick na placa
+    JOURNAL_SOURCE_HTTP = 1,      // Rotas HTTP das vagas
+    JOURNAL_SOURCE_WEBSOCKET = 2, // Mensagem "reservar:N" no /ws
+    JOURNAL_SOURCE_EXPIRY = 3,    // Reserva expirada
+    JOURNAL_SOURCE_ADMIN = 4,     // /admin/liberar-todas
+} journal_source_t;
+
+typedef enum journal_result
+{
+    JOURNAL_OK = 0,      // Registro lido
+    JOURNAL_PENDING = 1, // Sequência ainda não escrita (ou em escrita)
+    JOURNAL_LOST = 2,    // Registro já sobrescrito pelo anel
+} journal_result_t;
+
+// Registro de uma transição
+typedef struct journal_record
+{
+    uint32_t seq;          // Número de sequência, crescente a partir de 0
+    uint32_t timestamp_ms; // Instante da transição em ms desde o boot
+    uint16_t spot;         // Índice da vaga
+    uint8_t old_status;    // Status anterior
+    uint8_t new_status;    // Novo status
+    uint8_t source;        // Origem (journal_source_t)
+} journal_record_t;
+
+// Posição do anel. O carimbo vale seq + 1 quando o registro está completo e 0 durante a escrita,
+// de modo que o leitor detecta um registro incompleto ou sobrescrito sem bloquear os escritores.
+typedef struct journal_slot
+{
+    _Atomic uint32_t stamp;     // seq + 1 do registro gravado (0 durante a escrita)
+    _Atomic uint32_t timestamp; // Instante da transição
+    _Atomic uint32_t packed;    // Vaga (16 bits), status anterior (2), novo status (2) e origem (4)
+} journal_slot_t;
+
+// Anel de tamanho fixo com vários escritores: cada escritor reserva uma sequência com fetch_add e
+// grava apenas a sua posição. Leitores copiam os registros e conferem o carimbo antes e depois.
+typedef struct journal
+{
+    journal_slot_t *slots; // Posições do anel
+    uint16_t capacity;     // Quantidade de posições (potência de 2)
+    _Atomic uint32_t head; // Próxima sequência a ser escrita
+} journal_t;
+
+void journal_init(journal_t *journal, journal_slot_t *slots, uint16_t capacity); // Inicializa o diário vazio
+uint32_t journal_append(journal_t *journal, uint32_t timestamp_ms, uint16_t spot,
+                        uint8_t old_status, uint8_t new_status, uint8_t source); // Registra uma transição e retorna sua sequência
+uint32_t journal_head(const journal_t *journal);                                 // Próxima sequência a ser escrita
+uint32_t journal_oldest(const journal_t *journal);                               // Sequência mais antiga ainda no anel
+journal_result_t journal_read(const journal_t *journal, uint32_t seq, journal_record_t *record); // Lê o registro de uma sequência
+
+#endif // JOURNAL_H
@@ -0,0 +1,322 @@
+#include "parking.h"
+
+// Transições permitidas, indexadas pelo estado de destino:
+// livre -> reservada | ocupada, reservada -> ocupada | livre, ocupada -> livre
+static const uint32_t parking_allowed_from[] = {
+    [PARKING_FREE] = PARKING_FROM(PARKING_OCCUPIED) | PARKING_FROM(PARKING_RESERVED),
+    [PARKING_OCCUPIED] = PARKING_FROM(PARKING_FREE) | PARKING_FROM(PARKING_RESERVED),
+    [PARKING_RESERVED] = PARKING_FROM(PARKING_FREE),
+};
+
+static inline unsigned parking_shift(uint16_t index)
+{
+    return (index % PARKING_SPOTS_PER_WORD) * PARKING_BITS_PER_SPOT;
+}
+
+// Delimita a janela de escrita do seqlock: begin_seq é incrementado antes de alterar qualquer
+// palavra e end_seq depois de atualizar o índice, então begin_seq == end_seq indica que nenhuma
+// transição está em andamento (vários escritores podem estar dentro da janela ao mesmo tempo)
+static inline void parking_write_begin(parking_store_t *store)
+{
+    atomic_fetch_add_explicit(&store->begin_seq, 1, memory_order_acq_rel);
+}
+
+static inline void parking_write_end(parking_store_t *store)
+{
+    atomic_fetch_add_explicit(&store->end_seq, 1, memory_order_release);
+}
+
+static inline uint32_t parking_load_spot(const parking_store_t *store, uint16_t index)
+{
+    uint32_t word = atomic_load_explicit(&store->words[index / PARKING_SPOTS_PER_WORD], memory_order_acquire);
+    return (word >> parking_shift(index)) & 0xFu;
+}
+
+// Move a vaga entre os status nos contadores da zona e do andar
+static void parking_move_group(parking_store_t *store, uint16_t index, parking_status_t from, parking_status_t to)
+{
+    int zone = parking_zone_of(store, index);
+    if (zone < 0)
+        return;
+
+    uint8_t floor = store->zones[zone].floor;
+    atomic_fetch_sub_explicit(&store->zone_counts[zone][from], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&store->zone_counts[zone][to], 1, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&store->floor_counts[floor][from], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&store->floor_counts[floor][to], 1, memory_order_relaxed);
+}
+
+// Marca a vaga como livre no bitmap da classe; o resumo é marcado depois da palavra
+static void parking_mark_free(parking_store_t *store, parking_class_t cls, uint16_t index)
+{
+    uint16_t word = index / 32;
+    atomic_fetch_or_explicit(&store->free_bits[cls][word], 1u << (index % 32), memory_order_acq_rel);
+    atomic_fetch_or_explicit(&store->free_summary[cls][word / 32], 1u << (word % 32), memory_order_acq_rel);
+}
+
+// Desmarca a vaga no bitmap da classe. Se a palavra ficou vazia o resumo é limpo e a palavra conferida
+// de novo, porque outra tarefa pode ter marcado uma vaga entre as duas operações.
+static void parking_mark_used(parking_store_t *store, parking_class_t cls, uint16_t index)
+{
+    uint16_t word = index / 32;
+    uint32_t bit = 1u << (index % 32);
+    uint32_t summary_bit = 1u << (word % 32);
+
+    if ((atomic_fetch_and_explicit(&store->free_bits[cls][word], ~bit, memory_order_acq_rel) & ~bit) != 0)
+        return;
+
+    atomic_fetch_and_explicit(&store->free_summary[cls][word / 32], ~summary_bit, memory_order_acq_rel);
+    if (atomic_load_explicit(&store->free_bits[cls][word], memory_order_acquire) != 0)
+        atomic_fetch_or_explicit(&store->free_summary[cls][word / 32], summary_bit, memory_order_acq_rel);
+}
+
+// Inicializa todas as vagas livres e comuns; os buffers, o tamanho e as zonas (se houver) já devem estar preenchidos
+void parking_init(parking_store_t *store)
+{
+    uint16_t size = store->size;
+
+    for (size_t i = 0; i < PARKING_STORE_WORDS(size); i++)
+        atomic_init(&store->words[i], 0);
+    for (size_t i = 0; i < size; i++)
+        store->since_ms[i] = 0;
+
+    for (int cls = 0; cls < PARKING_CLASS_COUNT; cls++)
+    {
+        for (size_t i = 0; i < PARKING_BITMAP_WORDS(size); i++)
+            atomic_init(&store->free_bits[cls][i], 0);
+        for (size_t i = 0; i < PARKING_SUMMARY_WORDS(size); i++)
+            atomic_init(&store->free_summary[cls][i], 0);
+        for (int status = 0; status < PARKING_STATUS_COUNT; status++)
+            atomic_init(&store->counts[cls][status], 0);
+    }
+
+    for (uint16_t i = 0; i < size; i++)
+        parking_mark_free(store, PARKING_CLASS_REGULAR, i);
+    atomic_store(&store->counts[PARKING_CLASS_REGULAR][PARKING_FREE], size);
+
+    // Contadores de zonas e andares começam com todas as vagas livres
+    for (int f = 0; f < store->floor_count; f++)
+        for (int status = 0; status < PARKING_STATUS_COUNT; status++)
+            atomic_init(&store->floor_counts[f][status], 0);
+    for (int z = 0; z < store->zone_count; z++)
+    {
+        for (int status = 0; status < PARKING_STATUS_COUNT; status++)
+            atomic_init(&store->zone_counts[z][status], 0);
+        atomic_store(&store->zone_counts[z][PARKING_FREE], store->zones[z].count);
+        atomic_fetch_add(&store->floor_counts[store->zones[z].floor][PARKING_FREE], store->zones[z].count);
+    }
+
+    atomic_init(&store->begin_seq, 0);
+    atomic_init(&store->end_seq, 0);
+}
+
+// Marca ou desmarca uma vaga como PCD sem alterar o status. Move a vaga entre os contadores e
+// bitmaps das classes, por isso deve ser usada apenas na configuração, antes das transições.
+void parking_set_pcd(parking_store_t *store, uint16_t index, bool pcd)
+{
+    if (index >= store->size || parking_is_pcd(store, index) == pcd)
+        return;
+
+    parking_word_t *word = &store->words[index / PARKING_SPOTS_PER_WORD];
+    uint32_t flag = PARKING_PCD_FLAG << parking_shift(index);
+    parking_class_t from = pcd ? PARKING_CLASS_REGULAR : PARKING_CLASS_PCD;
+    parking_class_t to = pcd ? PARKING_CLASS_PCD : PARKING_CLASS_REGULAR;
+    parking_status_t status = parking_get_status(store, index);
+
+    parking_write_begin(store);
+
+    if (pcd)
+        atomic_fetch_or_explicit(word, flag, memory_order_acq_rel);
+    else
+        atomic_fetch_and_explicit(word, ~flag, memory_order_acq_rel);
+
+    atomic_fetch_sub(&store->counts[from][status], 1);
+    atomic_fetch_add(&store->counts[to][status], 1);
+    if (status == PARKING_FREE)
+    {
+        parking_mark_used(store, from, index);
+        parking_mark_free(store, to, index);
+    }
+
+    parking_write_end(store);
+}
+
+// Lê o status de uma vaga
+parking_status_t parking_get_status(const parking_store_t *store, uint16_t index)
+{
+    return (parking_status_t)(parking_load_spot(store, index) & PARKING_STATUS_MASK);
+}
+
+// Indica se a vaga é PCD
+bool parking_is_pcd(const parking_store_t *store, uint16_t index)
+{
+    return (parking_load_spot(store, index) & PARKING_PCD_FLAG) != 0;
+}
+
+// Instante da última transição da vaga
+uint32_t parking_since_ms(const parking_store_t *store, uint16_t index)
+{
+    return store->since_ms[index];
+}
+
+// Leva a vaga para o estado "to" se o estado atual estiver em from_mask e a transição for permitida.
+// O instante é gravado só depois de um compare-and-swap bem-sucedido, ainda dentro da escrita do
+// seqlock: uma tentativa que perde a disputa não sobrescreve o instante da vencedora, e as cópias
+// consistentes sempre trazem o status junto com o seu instante.
+// Retorna false (sem alterar nada) se o estado atual não aceita a transição.
+bool parking_transition(parking_store_t *store, uint16_t index, uint32_t from_mask,
+                        parking_status_t to, uint32_t now_ms, parking_status_t *previous)
+{
+    if (index >= store->size || to > PARKING_RESERVED)
+        return false;
+
+    from_mask &= parking_allowed_from[to];
+
+    parking_word_t *word = &store->words[index / PARKING_SPOTS_PER_WORD];
+    unsigned shift = parking_shift(index);
+
+    parking_write_begin(store);
+    uint32_t expected = atomic_load_explicit(word, memory_order_acquire);
+
+    while (1)
+    {
+        parking_status_t current = (parking_status_t)((expected >> shift) & PARKING_STATUS_MASK);
+        if (previous)
+            *previous = current;
+        if (!(from_mask & PARKING_FROM(current)))
+        {
+            parking_write_end(store);
+            return false;
+        }
+
+        uint32_t desired = (expected & ~(PARKING_STATUS_MASK << shift)) | ((uint32_t)to << shift);
+        if (atomic_compare_exchange_weak_explicit(word, &expected, desired,
+                                                  memory_order_acq_rel, memory_order_acquire))
+        {
+            store->since_ms[index] = now_ms;
+
+            // Atualiza o índice de disponibilidade com a transição que acabou de vencer
+            parking_class_t cls = (expected >> shift) & PARKING_PCD_FLAG ? PARKING_CLASS_PCD : PARKING_CLASS_REGULAR;
+            atomic_fetch_sub_explicit(&store->counts[cls][current], 1, memory_order_relaxed);
+            atomic_fetch_add_explicit(&store->counts[cls][to], 1, memory_order_relaxed);
+            parking_move_group(store, index, current, to);
+            if (current == PARKING_FREE)
+                parking_mark_used(store, cls, index);
+            else if (to == PARKING_FREE)
+                parking_mark_free(store, cls, index);
+            parking_write_end(store);
+            return true;
+        }
+        // Outra vaga da mesma palavra (ou esta) mudou: tenta de novo com o valor atual
+    }
+}
+
+// Vagas de uma classe com o status indicado
+uint16_t parking_count(const parking_store_t *store, parking_class_t cls, parking_status_t status)
+{
+    return atomic_load_explicit(&store->counts[cls][status], memory_order_relaxed);
+}
+
+// Vagas com o status indicado, somando todas as classes
+uint16_t parking_count_status(const parking_store_t *store, parking_status_t status)
+{
+    uint16_t total = 0;
+    for (int cls = 0; cls < PARKING_CLASS_COUNT; cls++)
+        total += parking_count(store, (parking_class_t)cls, status);
+    return total;
+}
+
+// Zona da vaga por busca binária na tabela de zonas (-1 se não há zonas ou a vaga está fora delas)
+int parking_zone_of(const parking_store_t *store, uint16_t index)
+{
+    int low = 0;
+    int high = (int)store->zone_count - 1;
+
+    while (low <= high)
+    {
+        int mid = (low + high) / 2;
+        const parking_zone_t *zone = &store->zones[mid];
+        if (index < zone->first)
+            high = mid - 1;
+        else if (index >= zone->first + zone->count)
+            low = mid + 1;
+        else
+            return mid;
+    }
+    return -1;
+}
+
+// Vagas da zona com o status indicado
+uint16_t parking_zone_count(const parking_store_t *store, uint8_t zone, parking_status_t status)
+{
+    return atomic_load_explicit(&store->zone_counts[zone][status], memory_order_relaxed);
+}
+
+// Vagas do andar com o status indicado
+uint16_t parking_floor_count(const parking_store_t *store, uint8_t floor, parking_status_t status)
+{
+    return atomic_load_explicit(&store->floor_counts[floor][status], memory_order_relaxed);
+}
+
+// Primeira vaga livre da classe: o resumo aponta a palavra do bitmap e __builtin_ctz o bit dentro dela
+int parking_find_free(const parking_store_t *store, parking_class_t cls)
+{
+    for (size_t s = 0; s < PARKING_SUMMARY_WORDS(store->size); s++)
+    {
+        uint32_t summary = atomic_load_explicit(&store->free_summary[cls][s], memory_order_acquire);
+        while (summary)
+        {
+            unsigned word = s * 32 + __builtin_ctz(summary);
+            uint32_t bits = atomic_load_explicit(&store->free_bits[cls][word], memory_order_acquire);
+            if (bits)
+                return word * 32 + __builtin_ctz(bits);
+            summary &= summary - 1; // Resumo desatualizado por uma transição concorrente: segue para a próxima
+        }
+    }
+    return -1;
+}
+
+// Copia palavras e contadores se nenhuma transição estava em andamento antes e durante a cópia.
+// Retorna false se precisa tentar de novo; o chamador decide como esperar (numa tarefa de prioridade
+// maior que a do escritor, repetir sem ceder a CPU nunca terminaria).
+bool parking_snapshot_try(const parking_store_t *store, parking_snapshot_t *snapshot)
+{
+    uint32_t end = atomic_load_explicit(&store->end_seq, memory_order_acquire);
+    uint32_t begin = atomic_load_explicit(&store->begin_seq, memory_order_acquire);
+    if (begin != end)
+        return false;
+
+    for (size_t i = 0; i < PARKING_STORE_WORDS(store->size); i++)
+        snapshot->words[i] = atomic_load_explicit(&store->words[i], memory_order_relaxed);
+    for (int cls = 0; cls < PARKING_CLASS_COUNT; cls++)
+        for (int status = 0; status < PARKING_STATUS_COUNT; status++)
+            snapshot->counts[cls][status] = atomic_load_explicit(&store->counts[cls][status], memory_order_relaxed);
+    for (int z = 0; snapshot->zone_counts && z < store->zone_count; z++)
+        for (int status = 0; status < PARKING_STATUS_COUNT; status++)
+            snapshot->zone_counts[z][status] = atomic_load_explicit(&store->zone_counts[z][status], memory_order_relaxed);
+    for (int f = 0; snapshot->floor_counts && f < store->floor_count; f++)
+        for (int status = 0; status < PARKING_STATUS_COUNT; status++)
+            snapshot->floor_counts[f][status] = atomic_load_explicit(&store->floor_counts[f][status], memory_order_relaxed);
+
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit(&store->begin_seq, memory_order_relaxed) != begin)
+        return false;
+
+    snapshot->seq = end;
+    snapshot->size = store->size;
+    return true;
+}
+
+// Status de uma vaga na cópia
+parking_status_t parking_snapshot_status(const parking_snapshot_t *snapshot, uint16_t index)
+{
+    uint32_t word = snapshot->words[index / PARKING_SPOTS_PER_WORD];
+    return (parking_status_t)((word >> parking_shift(index)) & PARKING_STATUS_MASK);
+}
+
+// Indica se a vaga é PCD na cópia
+bool parking_snapshot_is_pcd(const parking_snapshot_t *snapshot, uint16_t index)
+{
+    uint32_t word = snapshot->words[index / PARKING_SPOTS_PER_WORD];
+    return ((word >> parking_shift(index)) & PARKING_PCD_FLAG) != 0;
+}
@@ -0,0 +1,106 @@
+#ifndef PARKING_H
+#define PARKING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+// Cada vaga ocupa 4 bits de uma palavra de 32 bits: 2 bits de status, 1 bit PCD e 1 bit livre.
+// Uma palavra guarda 8 vagas, então 2000 vagas ocupam 1 KB (mais 8 KB de instantes de transição).
+#define PARKING_BITS_PER_SPOT 4
+#define PARKING_SPOTS_PER_WORD (32 / PARKING_BITS_PER_SPOT)
+#define PARKING_STORE_WORDS(spots) (((spots) + PARKING_SPOTS_PER_WORD - 1) / PARKING_SPOTS_PER_WORD)
+
+// Índice de disponibilidade: um bit por vaga livre em cada classe e um bit de resumo por palavra
+// não vazia do bitmap, de modo que a busca da próxima vaga livre lê no máximo algumas palavras
+#define PARKING_BITMAP_WORDS(spots) (((spots) + 31) / 32)
+#define PARKING_SUMMARY_WORDS(spots) ((PARKING_BITMAP_WORDS(spots) + 31) / 32)
+
+#define PARKING_STATUS_MASK 0x3u // Bits de status dentro dos 4 bits da vaga
+#define PARKING_PCD_FLAG 0x4u    // Bit da vaga exclusiva para PCD
+
+// Máscara de estados de origem aceitos por parking_transition
+#define PARKING_FROM(status) (1u << (status))
+#define PARKING_FROM_ANY (PARKING_FROM(PARKING_FREE) | PARKING_FROM(PARKING_OCCUPIED) | PARKING_FROM(PARKING_RESERVED))
+
+typedef enum parking_status
+{
+    PARKING_FREE = 0,     // Vaga livre
+    PARKING_OCCUPIED = 1, // Vaga ocupada
+    PARKING_RESERVED = 2, // Vaga reservada
+} parking_status_t;
+
+#define PARKING_STATUS_COUNT 3
+
+typedef enum parking_class
+{
+    PARKING_CLASS_REGULAR = 0, // Vaga comum
+    PARKING_CLASS_PCD = 1,     // Vaga exclusiva para PCD
+    PARKING_CLASS_COUNT
+} parking_class_t;
+
+typedef _Atomic uint32_t parking_word_t;
+
+// Zona: faixa contígua de vagas em um andar. As zonas ficam em ordem de primeira vaga e cobrem
+// todas as vagas, de modo que a zona de uma vaga é encontrada por busca binária.
+typedef struct parking_zone
+{
+    const char *name; // Nome curto exibido (ex.: "A")
+    uint16_t first;   // Primeira vaga da zona
+    uint16_t count;   // Quantidade de vagas
+    uint8_t floor;    // Andar da zona
+} parking_zone_t;
+
+typedef _Atomic uint16_t parking_counter_t[PARKING_STATUS_COUNT]; // Vagas de um grupo por status
+
+// Estado compacto das vagas. As palavras são alteradas apenas por compare-and-swap, então várias
+// tarefas podem mudar vagas (inclusive da mesma palavra) sem lock e sem perder atualizações.
+// Contadores (do estacionamento, de cada andar e de cada zona) e bitmaps de vagas livres são
+// atualizados a cada transição.
+typedef struct parking_store
+{
+    parking_word_t *words;                             // PARKING_STORE_WORDS(size) palavras com o estado das vagas
+    uint32_t *since_ms;                                // Instante da última transição de cada vaga (início da reserva ou da ocupação)
+    parking_word_t *free_bits[PARKING_CLASS_COUNT];    // PARKING_BITMAP_WORDS(size) palavras: vagas livres de cada classe
+    parking_word_t *free_summary[PARKING_CLASS_COUNT]; // PARKING_SUMMARY_WORDS(size) palavras: palavras não vazias do bitmap
+    uint16_t size;                                     // Quantidade de vagas
+    _Atomic uint16_t counts[PARKING_CLASS_COUNT][PARKING_STATUS_COUNT]; // Vagas por classe e status
+    const parking_zone_t *zones;                       // Zonas em ordem de primeira vaga (NULL: sem zonas)
+    uint8_t zone_count;                                // Quantidade de zonas
+    uint8_t floor_count;                               // Quantidade de andares (maior andar + 1)
+    parking_counter_t *zone_counts;                    // zone_count contadores, um por zona
+    parking_counter_t *floor_counts;                   // floor_count contadores, um por andar
+    _Atomic uint32_t begin_seq;                        // Transições iniciadas (seqlock)
+    _Atomic uint32_t end_seq;                          // Transições concluídas (seqlock)
+} parking_store_t;
+
+// Cópia consistente do estado: nenhuma transição ficou pela metade durante a cópia
+typedef struct parking_snapshot
+{
+    uint32_t seq;                                                // Transições concluídas até a cópia
+    uint16_t size;                                               // Quantidade de vagas
+    uint16_t counts[PARKING_CLASS_COUNT][PARKING_STATUS_COUNT]; // Vagas por classe e status
+    uint32_t *words;                                             // PARKING_STORE_WORDS(size) palavras, fornecidas pelo chamador
+    uint16_t (*zone_counts)[PARKING_STATUS_COUNT];               // zone_count contadores, fornecidos pelo chamador (ou NULL)
+    uint16_t (*floor_counts)[PARKING_STATUS_COUNT];              // floor_count contadores, fornecidos pelo chamador (ou NULL)
+} parking_snapshot_t;
+
+void parking_init(parking_store_t *store);                              // Inicializa todas as vagas livres (buffers e size já preenchidos)
+void parking_set_pcd(parking_store_t *store, uint16_t index, bool pcd); // Marca ou desmarca uma vaga como PCD (apenas na configuração)
+parking_status_t parking_get_status(const parking_store_t *store, uint16_t index);                   // Lê o status de uma vaga
+bool parking_is_pcd(const parking_store_t *store, uint16_t index);                                   // Indica se a vaga é PCD
+uint32_t parking_since_ms(const parking_store_t *store, uint16_t index);                             // Instante da última transição da vaga
+bool parking_transition(parking_store_t *store, uint16_t index, uint32_t from_mask,
+                        parking_status_t to, uint32_t now_ms, parking_status_t *previous); // Aplica uma transição válida de forma atômica
+uint16_t parking_count(const parking_store_t *store, parking_class_t cls, parking_status_t status);   // Vagas de uma classe com o status
+uint16_t parking_count_status(const parking_store_t *store, parking_status_t status);                // Vagas com o status, de todas as classes
+int parking_zone_of(const parking_store_t *store, uint16_t index);                                  // Zona da vaga (-1 sem zonas)
+uint16_t parking_zone_count(const parking_store_t *store, uint8_t zone, parking_status_t status);    // Vagas da zona com o status
+uint16_t parking_floor_count(const parking_store_t *store, uint8_t floor, parking_status_t status);  // Vagas do andar com o status
+int parking_find_free(const parking_store_t *store, parking_class_t cls);                           // Primeira vaga livre da classe (-1 se não houver)
+bool parking_snapshot_try(const parking_store_t *store, parking_snapshot_t *snapshot);             // Tenta copiar o estado sem nenhuma transição em andamento
+parking_status_t parking_snapshot_status(const parking_snapshot_t *snapshot, uint16_t index);       // Status de uma vaga na cópia
+bool parking_snapshot_is_pcd(const parking_snapshot_t *snapshot, uint16_t index);                   // Indica se a vaga é PCD na cópia
+
+#endif // PARKING_H
@@ -14,8 +14,8 @@ void init_display(ssd1306_t *ssd)
     ssd1306_config(ssd);                                                        // Configura o display
     ssd1306_send_data(ssd);
 
-    ssd1306_init(ssd, WIDTH, HEIGHT, false, SSD1306_ADDRESS, SSD1306_I2C_PORT); // Inicializa o display
-    ssd1306_config(ssd);                                                        // Configura o display
+    ssd1306_config(ssd);                                                        // Configura de novo (o display pode ter perdido a primeira)
+    ssd1306_invalidate(ssd);                                                    // Reenvia a imagem inteira sem alocar outros buffers
     ssd1306_send_data(ssd);                                                     // Envia os dados para o display
     ssd1306_fill(ssd, false);                                                   // Limpa o display
     ssd1306_send_data(ssd);
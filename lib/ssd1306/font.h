@@ -101,4 +101,45 @@ static uint8_t font[] = {
 0x00, 0x41, 0x41, 0x77, 0x3E, 0x08, 0x08, 0x00, // }
 0x02, 0x03, 0x01, 0x03, 0x02, 0x03, 0x01, 0x00  // ~
 
-};
\ No newline at end of file
+};
+
+// Colunas usadas por cada glifo de font[] na versão proporcional: (primeira coluna << 4) | largura
+static const uint8_t font_spans[] = {
+    0x03, 0x32, 0x15, 0x07, 0x07, 0x07, 0x07, 0x13, //   ! " # $ % & '
+    0x24, 0x24, 0x08, 0x16, 0x23, 0x16, 0x32, 0x07, // ( ) * + , - . /
+    0x07, 0x16, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, // 0 1 2 3 4 5 6 7
+    0x07, 0x07, 0x32, 0x23, 0x15, 0x16, 0x25, 0x16, // 8 9 : ; < = > ?
+    0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, // @ A B C D E F G
+    0x07, 0x16, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, // H I J K L M N O
+    0x07, 0x07, 0x07, 0x07, 0x08, 0x07, 0x07, 0x07, // P Q R S T U V W
+    0x07, 0x07, 0x07, 0x24, 0x07, 0x24, 0x07, 0x08, // X Y Z [ \ ] ^ _
+    0x33, 0x07, 0x07, 0x07, 0x07, 0x07, 0x16, 0x07, // ` a b c d e f g
+    0x07, 0x24, 0x07, 0x07, 0x24, 0x07, 0x07, 0x07, // h i j k l m n o
+    0x07, 0x07, 0x07, 0x07, 0x16, 0x07, 0x07, 0x07, // p q r s t u v w
+    0x07, 0x07, 0x07, 0x16, 0x32, 0x16, 0x07, // x y z { | } ~
+};
+
+// Dígitos de 16 pixels (2 páginas), ampliados 2x das colunas 0 a 6 dos dígitos de font[]: 14
+// colunas por glifo, cada coluna com o byte da página de cima seguido do da página de baixo
+static const uint8_t font_digits[] = {
+    0xFC, 0x0F, 0xFC, 0x0F, 0xFF, 0x3F, 0xFF, 0x3F, 0xC3, 0x33, 0xC3, 0x33, 0xF3, 0x30, // 0
+    0xF3, 0x30, 0x3F, 0x30, 0x3F, 0x30, 0xFF, 0x3F, 0xFF, 0x3F, 0xFC, 0x0F, 0xFC, 0x0F,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x00, 0x30, 0x0C, 0x30, 0x0C, 0x30, 0xFF, 0x3F, // 1
+    0xFF, 0x3F, 0xFF, 0x3F, 0xFF, 0x3F, 0x00, 0x30, 0x00, 0x30, 0x00, 0x30, 0x00, 0x30,
+    0x0C, 0x3F, 0x0C, 0x3F, 0xCF, 0x3F, 0xCF, 0x3F, 0xC3, 0x30, 0xC3, 0x30, 0xC3, 0x30, // 2
+    0xC3, 0x30, 0xC3, 0x30, 0xC3, 0x30, 0xFF, 0x30, 0xFF, 0x30, 0x3C, 0x30, 0x3C, 0x30,
+    0x03, 0x30, 0x03, 0x30, 0x03, 0x30, 0x03, 0x30, 0xC3, 0x30, 0xC3, 0x30, 0xC3, 0x30, // 3
+    0xC3, 0x30, 0xC3, 0x30, 0xC3, 0x30, 0xFF, 0x3F, 0xFF, 0x3F, 0x3C, 0x0F, 0x3C, 0x0F,
+    0xFC, 0x03, 0xFC, 0x03, 0xFC, 0x03, 0xFC, 0x03, 0x00, 0x03, 0x00, 0x03, 0x00, 0x03, // 4
+    0x00, 0x03, 0xFF, 0x3F, 0xFF, 0x3F, 0xFF, 0x3F, 0xFF, 0x3F, 0x00, 0x03, 0x00, 0x03,
+    0x3F, 0x0C, 0x3F, 0x0C, 0x3F, 0x3C, 0x3F, 0x3C, 0x33, 0x30, 0x33, 0x30, 0x33, 0x30, // 5
+    0x33, 0x30, 0x33, 0x30, 0x33, 0x30, 0xF3, 0x3F, 0xF3, 0x3F, 0xC3, 0x0F, 0xC3, 0x0F,
+    0xFC, 0x0F, 0xFC, 0x0F, 0xFF, 0x3F, 0xFF, 0x3F, 0xC3, 0x30, 0xC3, 0x30, 0xC3, 0x30, // 6
+    0xC3, 0x30, 0xC3, 0x30, 0xC3, 0x30, 0xC3, 0x3F, 0xC3, 0x3F, 0x00, 0x0F, 0x00, 0x0F,
+    0x03, 0x00, 0x03, 0x00, 0x03, 0x00, 0x03, 0x00, 0x03, 0x3C, 0x03, 0x3C, 0x03, 0x3F, // 7
+    0x03, 0x3F, 0xC3, 0x03, 0xC3, 0x03, 0xFF, 0x00, 0xFF, 0x00, 0x3F, 0x00, 0x3F, 0x00,
+    0x3C, 0x0F, 0x3C, 0x0F, 0xFF, 0x3F, 0xFF, 0x3F, 0xC3, 0x30, 0xC3, 0x30, 0xC3, 0x30, // 8
+    0xC3, 0x30, 0xC3, 0x30, 0xC3, 0x30, 0xFF, 0x3F, 0xFF, 0x3F, 0x3C, 0x0F, 0x3C, 0x0F,
+    0x3C, 0x00, 0x3C, 0x00, 0xFF, 0x30, 0xFF, 0x30, 0xC3, 0x30, 0xC3, 0x30, 0xC3, 0x30, // 9
+    0xC3, 0x30, 0xC3, 0x30, 0xC3, 0x30, 0xFF, 0x3F, 0xFF, 0x3F, 0xFC, 0x0F, 0xFC, 0x0F,
+};
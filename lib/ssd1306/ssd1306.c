@@ -1,5 +1,38 @@
+#include <string.h>
+
 #include "ssd1306.h"
 #include "font.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+
+#define SSD1306_COMMAND_CHUNK 32 // Comandos por transação em ssd1306_commands
+#define SSD1306_WINDOW_HEADER 13 // 6 comandos com Co = 1 (0x80 + comando) e o byte de controle 0x40
+
+static ssd1306_t *ssd1306_dma_displays[NUM_DMA_CHANNELS]; // Display de cada canal, para a IRQ
+
+const ssd1306_font_t ssd1306_font_8x8 = {font, NULL, ' ', '~', 8, 1, 0};
+const ssd1306_font_t ssd1306_font_proportional = {font, font_spans, ' ', '~', 8, 1, 1};
+const ssd1306_font_t ssd1306_font_digits_16 = {font_digits, NULL, '0', '9', 14, 2, 2};
+
+// Sequência de inicialização, enviada em uma transação
+static const uint8_t ssd1306_config_commands[] = {
+  SET_DISP | 0x00,
+  SET_MEM_ADDR, 0x01,
+  SET_DISP_START_LINE | 0x00,
+  SET_SEG_REMAP | 0x01,
+  SET_MUX_RATIO, HEIGHT - 1,
+  SET_COM_OUT_DIR | 0x08,
+  SET_DISP_OFFSET, 0x00,
+  SET_COM_PIN_CFG, 0x12,
+  SET_DISP_CLK_DIV, 0x80,
+  SET_PRECHARGE, 0xF1,
+  SET_VCOM_DESEL, 0x30,
+  SET_CONTRAST, 0xFF,
+  SET_ENTIRE_ON,
+  SET_NORM_INV,
+  SET_CHARGE_PUMP, 0x14,
+  SET_DISP | 0x01,
+};
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
   ssd->width = width;
@@ -8,113 +41,349 @@ void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_v
   ssd->address = address;
   ssd->i2c_port = i2c;
   ssd->bufsize = ssd->pages * ssd->width + 1;
-  ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+  // O byte de controle 0x40 fica logo antes da imagem, que assim começa alinhada em 4 bytes
+  // para as operações por palavra
+  ssd->ram_buffer = (uint8_t *)calloc(ssd->bufsize + 3, sizeof(uint8_t)) + 3;
   ssd->ram_buffer[0] = 0x40;
-  ssd->port_buffer[0] = 0x80;
+  ssd->window_buffer = calloc(SSD1306_WINDOW_HEADER + ssd->bufsize - 1, sizeof(uint8_t));
+  ssd->dma_channel = -1;
+  ssd->tx_words = NULL;
+  ssd->tx_busy = false;
+  ssd->start_line = 0; // ssd1306_config começa na linha 0
+  ssd->start_line_pending = false;
+  memset(ssd->dirty_left, 0xFF, sizeof(ssd->dirty_left));
+  memset(ssd->dirty_right, 0x00, sizeof(ssd->dirty_right));
+  ssd1306_invalidate(ssd); // A RAM do display começa com conteúdo indefinido
 }
 
 void ssd1306_config(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_DISP | 0x00);
-  ssd1306_command(ssd, SET_MEM_ADDR);
-  ssd1306_command(ssd, 0x01);
-  ssd1306_command(ssd, SET_DISP_START_LINE | 0x00);
-  ssd1306_command(ssd, SET_SEG_REMAP | 0x01);
-  ssd1306_command(ssd, SET_MUX_RATIO);
-  ssd1306_command(ssd, HEIGHT - 1);
-  ssd1306_command(ssd, SET_COM_OUT_DIR | 0x08);
-  ssd1306_command(ssd, SET_DISP_OFFSET);
-  ssd1306_command(ssd, 0x00);
-  ssd1306_command(ssd, SET_COM_PIN_CFG);
-  ssd1306_command(ssd, 0x12);
-  ssd1306_command(ssd, SET_DISP_CLK_DIV);
-  ssd1306_command(ssd, 0x80);
-  ssd1306_command(ssd, SET_PRECHARGE);
-  ssd1306_command(ssd, 0xF1);
-  ssd1306_command(ssd, SET_VCOM_DESEL);
-  ssd1306_command(ssd, 0x30);
-  ssd1306_command(ssd, SET_CONTRAST);
-  ssd1306_command(ssd, 0xFF);
-  ssd1306_command(ssd, SET_ENTIRE_ON);
-  ssd1306_command(ssd, SET_NORM_INV);
-  ssd1306_command(ssd, SET_CHARGE_PUMP);
-  ssd1306_command(ssd, 0x14);
-  ssd1306_command(ssd, SET_DISP | 0x01);
+  ssd1306_commands(ssd, ssd1306_config_commands, sizeof(ssd1306_config_commands));
+}
+
+// Dispara a transferência das primeiras "words" palavras do buffer da frente
+static void ssd1306_dma_start(ssd1306_t *ssd, size_t words) {
+  i2c_get_hw(ssd->i2c_port)->clr_tx_abrt; // Libera o FIFO se o envio anterior foi abortado (NACK)
+  ssd->tx_busy = true;
+  dma_channel_transfer_from_buffer_now(ssd->dma_channel, ssd->tx_words, words);
 }
 
 void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
-  ssd->port_buffer[1] = command;
-  i2c_write_blocking(
-    ssd->i2c_port,
-    ssd->address,
-    ssd->port_buffer,
-    2,
-    false
-  );
+  ssd1306_commands(ssd, &command, 1);
+}
+
+// Envia uma lista de comandos em uma transação só: byte de controle 0x00 (Co = 0, D/C = 0) seguido
+// dos comandos e seus argumentos. Listas longas são divididas em transações de SSD1306_COMMAND_CHUNK.
+void ssd1306_commands(ssd1306_t *ssd, const uint8_t *commands, size_t len) {
+  while (len) {
+    size_t chunk = (len < SSD1306_COMMAND_CHUNK) ? len : SSD1306_COMMAND_CHUNK;
+
+    // Com DMA os comandos também vão pelo FIFO: i2c_write_blocking reconfiguraria o controlador
+    // no meio dos bytes ainda na fila
+    if (ssd->dma_channel >= 0) {
+      while (ssd->tx_busy)
+        tight_loop_contents();
+      ssd->tx_words[0] = 0x00;
+      for (size_t i = 0; i < chunk; ++i)
+        ssd->tx_words[1 + i] = commands[i];
+      ssd->tx_words[chunk] |= I2C_IC_DATA_CMD_STOP_BITS;
+      ssd1306_dma_start(ssd, chunk + 1);
+    } else {
+      uint8_t buffer[1 + SSD1306_COMMAND_CHUNK] = {0x00};
+      memcpy(&buffer[1], commands, chunk);
+      i2c_write_blocking(
+        ssd->i2c_port,
+        ssd->address,
+        buffer,
+        chunk + 1,
+        false
+      );
+    }
+
+    commands += chunk;
+    len -= chunk;
+  }
+}
+
+// Marca as colunas x0..x1 das páginas page0..page1 como alteradas
+static inline void ssd1306_mark(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t page0, uint8_t page1) {
+  for (uint8_t page = page0; page <= page1; ++page) {
+    if (x0 < ssd->dirty_left[page])
+      ssd->dirty_left[page] = x0;
+    if (x1 > ssd->dirty_right[page])
+      ssd->dirty_right[page] = x1;
+  }
+}
+
+// Marca a tela inteira para o próximo envio
+void ssd1306_invalidate(ssd1306_t *ssd) {
+  ssd1306_mark(ssd, 0, ssd->width - 1, 0, ssd->pages - 1);
+}
+
+// Fim de uma transferência: libera o buffer da frente e avisa quem espera
+static void ssd1306_dma_irq(void) {
+  for (int channel = 0; channel < NUM_DMA_CHANNELS; ++channel) {
+    ssd1306_t *ssd = ssd1306_dma_displays[channel];
+    if (!ssd || !dma_channel_get_irq1_status(channel))
+      continue;
+    dma_channel_acknowledge_irq1(channel);
+    ssd->tx_busy = false;
+    if (ssd->flush_done)
+      ssd->flush_done(ssd->flush_ctx);
+  }
+}
+
+// Passa o envio para DMA: cada palavra vai para o IC_DATA_CMD (byte + bit de STOP no fim de cada
+// transação), no ritmo do DREQ de TX do I2C. Chamar depois de ssd1306_config; a partir daqui
+// ssd1306_send_data só monta o buffer da frente e retorna, e flush_done é chamada (na IRQ) ao fim.
+bool ssd1306_dma_init(ssd1306_t *ssd, void (*flush_done)(void *ctx), void *ctx) {
+  int channel = dma_claim_unused_channel(false);
+  if (channel < 0)
+    return false;
+
+  // Pior caso: todas as páginas em janelas de uma página, cada uma com o seu cabeçalho
+  ssd->tx_words = malloc((ssd->width * ssd->pages + ssd->pages * SSD1306_WINDOW_HEADER) * sizeof(uint16_t));
+  if (!ssd->tx_words) {
+    dma_channel_unclaim(channel);
+    return false;
+  }
+
+  // O endereço do display fica fixo no controlador; os envios bloqueantes anteriores já terminaram
+  i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+  hw->enable = 0;
+  hw->tar = ssd->address;
+  hw->enable = 1;
+
+  dma_channel_config config = dma_channel_get_default_config(channel);
+  channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+  channel_config_set_read_increment(&config, true);
+  channel_config_set_write_increment(&config, false);
+  channel_config_set_dreq(&config, i2c_get_dreq(ssd->i2c_port, true));
+  dma_channel_configure(channel, &config, &hw->data_cmd, ssd->tx_words, 0, false);
+
+  ssd->flush_done = flush_done;
+  ssd->flush_ctx = ctx;
+  ssd->dma_channel = channel;
+  ssd1306_dma_displays[channel] = ssd;
+
+  static bool irq_installed = false;
+  if (!irq_installed) {
+    irq_add_shared_handler(SSD1306_DMA_IRQ, ssd1306_dma_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(SSD1306_DMA_IRQ, true);
+    irq_installed = true;
+  }
+  dma_channel_set_irq1_enabled(channel, true);
+  return true;
+}
+
+// Indica se o buffer da frente ainda está sendo transferido
+bool ssd1306_busy(const ssd1306_t *ssd) {
+  return ssd->tx_busy;
+}
+
+// Rolagem vertical por hardware: a RAM é um anel de 64 linhas e o display começa a varredura em
+// "line". O comando vai junto do próximo ssd1306_send_data, antes das páginas alteradas.
+void ssd1306_set_start_line(ssd1306_t *ssd, uint8_t line) {
+  line %= ssd->height;
+  if (line != ssd->start_line) {
+    ssd->start_line = line;
+    ssd->start_line_pending = true;
+  }
 }
 
+// Cabeçalho de uma escrita de janela: SET_COL_ADDR e SET_PAGE_ADDR com Co = 1 (cada byte de comando
+// vem depois do seu byte de controle 0x80) e, por fim, 0x40 (Co = 0, D/C = 1): o resto da transação
+// são dados. Janela e dados vão assim na mesma transação.
+static void ssd1306_window_header(uint8_t *header, uint8_t left, uint8_t right, uint8_t page0, uint8_t page1) {
+  const uint8_t commands[] = {SET_COL_ADDR, left, right, SET_PAGE_ADDR, page0, page1};
+  for (size_t i = 0; i < sizeof(commands); ++i) {
+    header[2 * i] = 0x80;
+    header[2 * i + 1] = commands[i];
+  }
+  header[SSD1306_WINDOW_HEADER - 1] = 0x40;
+}
+
+// Envia só as páginas alteradas. Páginas alteradas seguidas formam uma janela (união das colunas),
+// escrita em uma transação com o cabeçalho acima; no endereçamento vertical a janela é transmitida
+// coluna por coluna, então cada coluna é um trecho contínuo de ram_buffer. Com DMA as janelas são copiadas
+// para o buffer da frente e a função retorna sem esperar o barramento; o desenho segue em ram_buffer.
 void ssd1306_send_data(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_COL_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->width - 1);
-  ssd1306_command(ssd, SET_PAGE_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->pages - 1);
-  i2c_write_blocking(
-    ssd->i2c_port,
-    ssd->address,
-    ssd->ram_buffer,
-    ssd->bufsize,
-    false
-  );
+  size_t words = 0;
+
+  // O buffer da frente só pode ser reescrito depois da transferência anterior
+  while (ssd->tx_busy)
+    tight_loop_contents();
+
+  if (ssd->start_line_pending) {
+    uint8_t command = SET_DISP_START_LINE | ssd->start_line;
+    if (ssd->dma_channel >= 0) {
+      ssd->tx_words[words++] = 0x00;
+      ssd->tx_words[words++] = command | I2C_IC_DATA_CMD_STOP_BITS;
+    } else {
+      ssd1306_command(ssd, command);
+    }
+    ssd->start_line_pending = false;
+  }
+
+  uint8_t page = 0;
+  while (page < ssd->pages) {
+    if (ssd->dirty_left[page] > ssd->dirty_right[page]) {
+      page++;
+      continue;
+    }
+
+    uint8_t page0 = page, left = ssd->dirty_left[page], right = ssd->dirty_right[page];
+    while (++page < ssd->pages && ssd->dirty_left[page] <= ssd->dirty_right[page]) {
+      if (ssd->dirty_left[page] < left)
+        left = ssd->dirty_left[page];
+      if (ssd->dirty_right[page] > right)
+        right = ssd->dirty_right[page];
+    }
+    uint8_t page1 = page - 1;
+    uint8_t height = page1 - page0 + 1;
+
+    uint8_t header[SSD1306_WINDOW_HEADER];
+    ssd1306_window_header(header, left, right, page0, page1);
+
+    if (ssd->dma_channel >= 0) {
+      for (size_t i = 0; i < sizeof(header); ++i)
+        ssd->tx_words[words++] = header[i];
+      for (uint8_t x = left; x <= right; ++x) {
+        const uint8_t *column = &ssd->ram_buffer[1 + x * ssd->pages + page0];
+        for (uint8_t i = 0; i < height; ++i)
+          ssd->tx_words[words++] = column[i];
+      }
+      ssd->tx_words[words - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+      continue;
+    }
+
+    memcpy(ssd->window_buffer, header, sizeof(header));
+    size_t len = sizeof(header);
+    for (uint8_t x = left; x <= right; ++x, len += height)
+      memcpy(&ssd->window_buffer[len], &ssd->ram_buffer[1 + x * ssd->pages + page0], height);
+
+    i2c_write_blocking(
+      ssd->i2c_port,
+      ssd->address,
+      ssd->window_buffer,
+      len,
+      false
+    );
+  }
+
+  memset(ssd->dirty_left, 0xFF, sizeof(ssd->dirty_left));
+  memset(ssd->dirty_right, 0x00, sizeof(ssd->dirty_right));
+
+  if (words)
+    ssd1306_dma_start(ssd, words);
+}
+
+// Bytes da coluna x: com o endereçamento vertical cada coluna ocupa "pages" bytes seguidos, um
+// por página de 8 linhas, com o bit 0 na linha de cima
+static inline uint8_t *ssd1306_column(ssd1306_t *ssd, uint8_t x) {
+  return &ssd->ram_buffer[1 + x * ssd->pages];
+}
+
+// Máscara das linhas y0..y1 (inclusive) dentro de uma palavra de 32 linhas começando em "base"
+static inline uint32_t ssd1306_span_mask(int y0, int y1, int base) {
+  if (y1 < base || y0 > base + 31)
+    return 0;
+  uint32_t mask = 0xFFFFFFFFu;
+  if (y0 > base)
+    mask <<= y0 - base;
+  if (y1 < base + 31)
+    mask &= 0xFFFFFFFFu >> (base + 31 - y1);
+  return mask;
+}
+
+// Liga ou desliga as linhas y0..y1 das colunas x0..x1 (já recortadas). Com 64 linhas a coluna são
+// duas palavras de 32 bits alinhadas; em outras alturas a coluna é tratada byte a byte.
+static void ssd1306_fill_span(ssd1306_t *ssd, int x0, int x1, int y0, int y1, bool value) {
+  ssd1306_mark(ssd, x0, x1, y0 >> 3, y1 >> 3);
+
+  if (ssd->pages == 8) {
+    uint32_t low = ssd1306_span_mask(y0, y1, 0);
+    uint32_t high = ssd1306_span_mask(y0, y1, 32);
+    uint32_t *column = (uint32_t *)ssd1306_column(ssd, x0);
+    for (int x = x0; x <= x1; ++x, column += 2) {
+      if (value) {
+        column[0] |= low;
+        column[1] |= high;
+      } else {
+        column[0] &= ~low;
+        column[1] &= ~high;
+      }
+    }
+    return;
+  }
+
+  for (int page = y0 >> 3; page <= y1 >> 3; ++page) {
+    uint8_t mask = (uint8_t)ssd1306_span_mask(y0 - page * 8, y1 - page * 8, 0);
+    uint8_t *byte = ssd1306_column(ssd, x0) + page;
+    for (int x = x0; x <= x1; ++x, byte += ssd->pages)
+      *byte = value ? (*byte | mask) : (*byte & ~mask);
+  }
+}
+
+// Recorta o retângulo x0..x1, y0..y1 (inclusive) na tela; falso se nada fica visível
+static inline bool ssd1306_clip(const ssd1306_t *ssd, int *x0, int *x1, int *y0, int *y1) {
+  if (*x0 < 0)
+    *x0 = 0;
+  if (*y0 < 0)
+    *y0 = 0;
+  if (*x1 >= ssd->width)
+    *x1 = ssd->width - 1;
+  if (*y1 >= ssd->height)
+    *y1 = ssd->height - 1;
+  return *x0 <= *x1 && *y0 <= *y1;
 }
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
-  uint16_t index = (y >> 3) + (x << 3) + 1;
+  if (x >= ssd->width || y >= ssd->height)
+    return;
+  ssd1306_mark(ssd, x, x, y >> 3, y >> 3);
+  uint8_t *byte = ssd1306_column(ssd, x) + (y >> 3);
   uint8_t pixel = (y & 0b111);
   if (value)
-    ssd->ram_buffer[index] |= (1 << pixel);
+    *byte |= (1 << pixel);
   else
-    ssd->ram_buffer[index] &= ~(1 << pixel);
+    *byte &= ~(1 << pixel);
 }
 
-/*
-void ssd1306_fill(ssd1306_t *ssd, bool value) {
-  uint8_t byte = value ? 0xFF : 0x00;
-  for (uint8_t i = 1; i < ssd->bufsize; ++i)
-    ssd->ram_buffer[i] = byte;
-}*/
-
 void ssd1306_fill(ssd1306_t *ssd, bool value) {
-    // Itera por todas as posições do display
-    for (uint8_t y = 0; y < ssd->height; ++y) {
-        for (uint8_t x = 0; x < ssd->width; ++x) {
-            ssd1306_pixel(ssd, x, y, value);
-        }
-    }
+  memset(ssd->ram_buffer + 1, value ? 0xFF : 0x00, ssd->bufsize - 1);
+  ssd1306_invalidate(ssd);
 }
 
-
-
 void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
-  for (uint8_t x = left; x < left + width; ++x) {
-    ssd1306_pixel(ssd, x, top, value);
-    ssd1306_pixel(ssd, x, top + height - 1, value);
-  }
-  for (uint8_t y = top; y < top + height; ++y) {
-    ssd1306_pixel(ssd, left, y, value);
-    ssd1306_pixel(ssd, left + width - 1, y, value);
-  }
+  if (!width || !height)
+    return;
+
+  int x0 = left, x1 = left + width - 1;
+  int y0 = top, y1 = top + height - 1;
 
   if (fill) {
-    for (uint8_t x = left + 1; x < left + width - 1; ++x) {
-      for (uint8_t y = top + 1; y < top + height - 1; ++y) {
-        ssd1306_pixel(ssd, x, y, value);
-      }
-    }
+    if (ssd1306_clip(ssd, &x0, &x1, &y0, &y1))
+      ssd1306_fill_span(ssd, x0, x1, y0, y1, value);
+    return;
   }
+
+  ssd1306_hline(ssd, x0, x1, y0, value);
+  ssd1306_hline(ssd, x0, x1, y1, value);
+  ssd1306_vline(ssd, x0, y0, y1, value);
+  ssd1306_vline(ssd, x1, y0, y1, value);
 }
 
 void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool value) {
+    // Linhas retas vão direto para os laços por byte
+    if (y0 == y1) {
+        ssd1306_hline(ssd, x0 < x1 ? x0 : x1, x0 < x1 ? x1 : x0, y0, value);
+        return;
+    }
+    if (x0 == x1) {
+        ssd1306_vline(ssd, x0, y0 < y1 ? y0 : y1, y0 < y1 ? y1 : y0, value);
+        return;
+    }
+
     int dx = abs(x1 - x0);
     int dy = abs(y1 - y0);
 
@@ -142,44 +411,146 @@ void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1
     }
 }
 
-
+// Linha horizontal: um byte por coluna, com a mesma máscara de bit
 void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value) {
-  for (uint8_t x = x0; x <= x1; ++x)
-    ssd1306_pixel(ssd, x, y, value);
+  int left = x0, right = x1, top = y, bottom = y;
+  if (!ssd1306_clip(ssd, &left, &right, &top, &bottom))
+    return;
+
+  ssd1306_mark(ssd, left, right, y >> 3, y >> 3);
+  uint8_t mask = 1 << (y & 0b111);
+  uint8_t *byte = ssd1306_column(ssd, left) + (y >> 3);
+  for (int x = left; x <= right; ++x, byte += ssd->pages)
+    *byte = value ? (*byte | mask) : (*byte & ~mask);
 }
 
+// Linha vertical: máscara do trecho aplicada aos bytes (ou palavras) da coluna
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
-  for (uint8_t y = y0; y <= y1; ++y)
-    ssd1306_pixel(ssd, x, y, value);
+  int left = x, right = x, top = y0, bottom = y1;
+  if (ssd1306_clip(ssd, &left, &right, &top, &bottom))
+    ssd1306_fill_span(ssd, left, right, top, bottom, value);
 }
 
-// Função para desenhar um caractere
-void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
+// Copia colunas prontas (pages bytes cada, bit 0 em cima) para a tela. Com y alinhado a uma página
+// cada coluna é um memcpy, pois as páginas de uma coluna são contíguas no framebuffer; fora do
+// alinhamento cada byte se divide entre duas páginas. O que passa das bordas é recortado.
+void ssd1306_blit(ssd1306_t *ssd, const uint8_t *columns, uint8_t width, uint8_t pages, uint8_t x, uint8_t y)
 {
-  uint16_t index = 0;
+  if (!width || !pages || x >= ssd->width || y >= ssd->height)
+    return;
 
-  // Verifica o caractere e calcula o índice correspondente na fonte
-  if (c >= ' ' && c <= '~') // Verifica se o caractere está na faixa ASCII válida
-  {
-    index = (c - ' ') * 8; // Calcula o índice baseado na posição do caractere na tabela ASCII
-  }
-  else
+  uint8_t count = (ssd->width - x < width) ? ssd->width - x : width; // Recorte na borda direita
+  uint8_t page = y >> 3;
+  uint8_t shift = y & 0b111;
+  uint8_t visible = (ssd->pages - page < pages) ? ssd->pages - page : pages; // Recorte embaixo
+  uint8_t *dst = ssd1306_column(ssd, x) + page;
+
+  if (!shift)
   {
-    // Caractere inválido, desenha um espaço (ou pode ser tratado de outra forma)
-    index = 0; // Índice 0 corresponde ao caractere "nada" (espaço)
+    ssd1306_mark(ssd, x, x + count - 1, page, page + visible - 1);
+    for (uint8_t i = 0; i < count; ++i, dst += ssd->pages, columns += pages)
+      memcpy(dst, columns, visible);
+    return;
   }
 
-  // Desenha o caractere na tela
-  for (uint8_t i = 0; i < 8; ++i)
+  bool lower = page + pages < ssd->pages; // A parte de baixo da última página ainda cabe na tela
+  ssd1306_mark(ssd, x, x + count - 1, page, lower ? page + pages : page + visible - 1);
+
+  uint8_t keep_upper = 0xFF >> (8 - shift);
+  uint8_t keep_lower = 0xFF << shift;
+  for (uint8_t i = 0; i < count; ++i, dst += ssd->pages, columns += pages)
   {
-    uint8_t line = font[index + i]; // Acessa a linha correspondente do caractere na fonte
-    for (uint8_t j = 0; j < 8; ++j)
+    for (uint8_t p = 0; p < visible; ++p)
     {
-      ssd1306_pixel(ssd, x + i, y + j, line & (1 << j)); // Desenha cada pixel do caractere
+      dst[p] = (dst[p] & keep_upper) | (uint8_t)(columns[p] << shift);
+      if (p + 1 < visible || lower)
+        dst[p + 1] = (dst[p + 1] & keep_lower) | (columns[p] >> (8 - shift));
     }
   }
 }
 
+// Colunas e largura do glifo de c; caracteres fora da tabela usam o primeiro glifo (espaço)
+static const uint8_t *ssd1306_glyph(const ssd1306_font_t *font, char c, uint8_t *width)
+{
+  uint8_t index = (c >= font->first && c <= font->last) ? c - font->first : 0;
+  const uint8_t *glyph = &font->glyphs[index * font->width * font->pages];
+
+  if (!font->spans)
+  {
+    *width = font->width;
+    return glyph;
+  }
+  *width = font->spans[index] & 0x0F;
+  return glyph + (font->spans[index] >> 4) * font->pages;
+}
+
+// Largura do texto em colunas, com o espaçamento entre glifos
+uint16_t ssd1306_text_width(const ssd1306_font_t *font, const char *str)
+{
+  uint16_t width = 0;
+  for (; *str; ++str)
+  {
+    uint8_t glyph_width;
+    ssd1306_glyph(font, *str, &glyph_width);
+    width += glyph_width + font->spacing;
+  }
+  return width;
+}
+
+// Desenha o texto em uma linha, sem quebra; retorna a coluna seguinte ao texto. O espaçamento entre
+// glifos também é copiado (colunas em branco), para apagar o que havia embaixo.
+uint8_t ssd1306_draw_text(ssd1306_t *ssd, const ssd1306_font_t *font, const char *str, uint8_t x, uint8_t y)
+{
+  static const uint8_t blank[4 * SSD1306_MAX_PAGES] = {0};
+
+  for (; *str && x < ssd->width; ++str)
+  {
+    uint8_t width;
+    const uint8_t *glyph = ssd1306_glyph(font, *str, &width);
+    ssd1306_blit(ssd, glyph, width, font->pages, x, y);
+    if (font->spacing)
+      ssd1306_blit(ssd, blank, font->spacing, font->pages, x + width, y);
+    x += width + font->spacing;
+  }
+  return x;
+}
+
+// Renderiza o texto uma vez em colunas; falso se não cabe em capacity bytes
+bool ssd1306_run_render(ssd1306_run_t *run, const ssd1306_font_t *font, const char *str, uint8_t *columns, size_t capacity)
+{
+  size_t size = (size_t)ssd1306_text_width(font, str) * font->pages;
+  if (size > capacity)
+    return false;
+
+  run->columns = columns;
+  run->width = 0;
+  run->pages = font->pages;
+  memset(columns, 0, size);
+
+  for (; *str; ++str)
+  {
+    uint8_t width;
+    const uint8_t *glyph = ssd1306_glyph(font, *str, &width);
+    memcpy(&columns[run->width * font->pages], glyph, width * font->pages);
+    run->width += width + font->spacing;
+  }
+  return true;
+}
+
+// Desenha um texto já renderizado: uma cópia por coluna, sem consultar a fonte
+void ssd1306_draw_run(ssd1306_t *ssd, const ssd1306_run_t *run, uint8_t x, uint8_t y)
+{
+  ssd1306_blit(ssd, run->columns, run->width > 255 ? 255 : run->width, run->pages, x, y);
+}
+
+// Função para desenhar um caractere (fonte 8x8 de largura fixa)
+void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
+{
+  uint8_t width;
+  const uint8_t *glyph = ssd1306_glyph(&ssd1306_font_8x8, c, &width);
+  ssd1306_blit(ssd, glyph, width, 1, x, y);
+}
+
 // Função para desenhar uma string
 void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y)
 {
@@ -7,6 +7,8 @@
 
 #define WIDTH 128
 #define HEIGHT 64
+#define SSD1306_MAX_PAGES 8 // Páginas de 8 linhas no maior display suportado (64 linhas)
+#define SSD1306_DMA_IRQ DMA_IRQ_1 // IRQ de fim de transferência (compartilhada)
 
 typedef enum {
   SET_CONTRAST = 0x81,
@@ -34,13 +36,49 @@ typedef struct {
   bool external_vcc;
   uint8_t *ram_buffer;
   size_t bufsize;
-  uint8_t port_buffer[2];
+  uint8_t dirty_left[SSD1306_MAX_PAGES];  // Primeira coluna alterada de cada página desde o último envio
+  uint8_t dirty_right[SSD1306_MAX_PAGES]; // Última coluna alterada (left > right: página sem mudanças)
+  uint8_t *window_buffer;                 // Comandos da janela + byte de controle + dados, montados a partir de ram_buffer
+  int dma_channel;                        // Canal de DMA do envio (-1: envio bloqueante)
+  uint16_t *tx_words;                     // Buffer da frente: comandos e janelas no formato do IC_DATA_CMD
+  volatile bool tx_busy;                  // Há uma transferência por DMA em andamento
+  void (*flush_done)(void *ctx);          // Chamada na IRQ ao fim da transferência
+  void *flush_ctx;                        // Contexto de flush_done
+  uint8_t start_line;                     // Linha da RAM mostrada no topo da tela (rolagem vertical)
+  bool start_line_pending;                // start_line ainda não foi enviada ao display
 } ssd1306_t;
 
+// Fonte em colunas prontas para a tela: cada coluna são "pages" bytes, um por página, com o bit 0
+// em cima (o formato do framebuffer), então desenhar um glifo é copiar bytes
+typedef struct ssd1306_font {
+  const uint8_t *glyphs; // width * pages bytes por glifo, coluna a coluna
+  const uint8_t *spans;  // Proporcional: (primeira coluna << 4) | largura de cada glifo; NULL: largura fixa
+  char first, last;      // Faixa de caracteres da tabela
+  uint8_t width;         // Colunas por glifo na tabela
+  uint8_t pages;         // Altura em páginas de 8 linhas
+  uint8_t spacing;       // Colunas em branco depois de cada glifo (até 4)
+} ssd1306_font_t;
+
+// Texto já renderizado em colunas (rótulos fixos): desenhar é uma cópia por coluna
+typedef struct ssd1306_run {
+  uint8_t *columns; // width * pages bytes, coluna a coluna (buffer do chamador)
+  uint16_t width;   // Colunas renderizadas
+  uint8_t pages;    // Altura em páginas
+} ssd1306_run_t;
+
+extern const ssd1306_font_t ssd1306_font_8x8;         // Fonte 8x8 de largura fixa
+extern const ssd1306_font_t ssd1306_font_proportional; // Fonte 8x8 com a largura de cada glifo
+extern const ssd1306_font_t ssd1306_font_digits_16;    // Dígitos de 16 pixels de altura
+
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
 void ssd1306_config(ssd1306_t *ssd);
 void ssd1306_command(ssd1306_t *ssd, uint8_t command);
+void ssd1306_commands(ssd1306_t *ssd, const uint8_t *commands, size_t len);
 void ssd1306_send_data(ssd1306_t *ssd);
+void ssd1306_invalidate(ssd1306_t *ssd);
+bool ssd1306_dma_init(ssd1306_t *ssd, void (*flush_done)(void *ctx), void *ctx);
+bool ssd1306_busy(const ssd1306_t *ssd);
+void ssd1306_set_start_line(ssd1306_t *ssd, uint8_t line);
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
 void ssd1306_fill(ssd1306_t *ssd, bool value);
@@ -50,5 +88,10 @@ void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value);
 void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y);
 void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
+void ssd1306_blit(ssd1306_t *ssd, const uint8_t *columns, uint8_t width, uint8_t pages, uint8_t x, uint8_t y);
+uint8_t ssd1306_draw_text(ssd1306_t *ssd, const ssd1306_font_t *font, const char *str, uint8_t x, uint8_t y);
+uint16_t ssd1306_text_width(const ssd1306_font_t *font, const char *str);
+bool ssd1306_run_render(ssd1306_run_t *run, const ssd1306_font_t *font, const char *str, uint8_t *columns, size_t capacity);
+void ssd1306_draw_run(ssd1306_t *ssd, const ssd1306_run_t *run, uint8_t x, uint8_t y);
 
 #endif // SSD1306_H
@@ -0,0 +1,126 @@
+#include <string.h>
+
+#include "view.h"
+
+// Colunas de cada célula (bit 0 em cima), com a coluna de espaço no fim
+static const uint8_t ssd1306_cells[SSD1306_CELL_COUNT][SSD1306_CELL_WIDTH] = {
+    {0x7E, 0x42, 0x42, 0x7E, 0x00}, // SSD1306_CELL_EMPTY
+    {0x7E, 0x7E, 0x7E, 0x7E, 0x00}, // SSD1306_CELL_FILLED
+    {0x7E, 0x56, 0x6A, 0x7E, 0x00}, // SSD1306_CELL_HATCHED
+    {0x00, 0x18, 0x18, 0x00, 0x00}, // SSD1306_CELL_DOT
+};
+
+// Células por linha: a grade ocupa da página top_page até o fim da tela, uma linha por página
+void ssd1306_grid_cell(ssd1306_t *ssd, int index, ssd1306_cell_t cell, uint8_t top_page)
+{
+    int per_row = ssd->width / SSD1306_CELL_WIDTH;
+    int page = top_page + index / per_row;
+    if (index < 0 || page >= ssd->pages || cell >= SSD1306_CELL_COUNT)
+        return;
+
+    ssd1306_blit(ssd, ssd1306_cells[cell], SSD1306_CELL_WIDTH, 1, (index % per_row) * SSD1306_CELL_WIDTH, page * 8);
+}
+
+void ssd1306_scroller_init(ssd1306_scroller_t *scroller, int rows, ssd1306_row_fn draw_row, void *ctx)
+{
+    scroller->draw_row = draw_row;
+    scroller->ctx = ctx;
+    scroller->rows = rows;
+    scroller->cycle = (rows > SSD1306_MAX_PAGES) ? rows + 1 : SSD1306_MAX_PAGES; // A linha em branco separa as voltas
+    scroller->position = 0;
+}
+
+bool ssd1306_scroller_scrolls(const ssd1306_scroller_t *scroller)
+{
+    return scroller->rows > SSD1306_MAX_PAGES;
+}
+
+// Linha da lista no bit "bit" da página "page" da RAM, na posição atual. A linha R da RAM aparece
+// na linha (R - início) da tela, que mostra o pixel position + (R - início) da lista.
+static int ssd1306_scroller_row_at(const ssd1306_t *ssd, const ssd1306_scroller_t *scroller, uint8_t page, uint8_t bit)
+{
+    uint32_t start = scroller->position % ssd->height;
+    uint32_t line = (page * 8 + bit + ssd->height - start) % ssd->height;
+    return (int)(((scroller->position + line) / 8) % scroller->cycle);
+}
+
+static void ssd1306_scroller_draw(ssd1306_t *ssd, ssd1306_scroller_t *scroller, int row, uint8_t page)
+{
+    if (row < scroller->rows)
+        scroller->draw_row(ssd, scroller->ctx, row, page * 8);
+    else
+        ssd1306_rect(ssd, page * 8, 0, ssd->width, 8, false, true);
+}
+
+static void ssd1306_scroller_copy_page(const ssd1306_t *ssd, uint8_t page, uint8_t *columns)
+{
+    for (uint8_t x = 0; x < ssd->width; ++x)
+        columns[x] = ssd->ram_buffer[1 + x * ssd->pages + page];
+}
+
+// Redesenha uma página da RAM. Fora do alinhamento a página tem os bits de baixo da linha que
+// está entrando por baixo e os de cima da que está saindo pelo topo: as duas são desenhadas e
+// combinadas pela máscara.
+static void ssd1306_scroller_refresh_page(ssd1306_t *ssd, ssd1306_scroller_t *scroller, uint8_t page)
+{
+    int first = ssd1306_scroller_row_at(ssd, scroller, page, 0);
+    int second = first;
+    uint8_t mask = 0;
+
+    for (uint8_t bit = 0; bit < 8; ++bit)
+    {
+        int row = ssd1306_scroller_row_at(ssd, scroller, page, bit);
+        if (row == first)
+            mask |= 1 << bit;
+        else
+            second = row;
+    }
+
+    ssd1306_scroller_draw(ssd, scroller, first, page);
+    if (mask == 0xFF)
+        return;
+
+    ssd1306_scroller_copy_page(ssd, page, scroller->scratch[0]);
+    ssd1306_scroller_draw(ssd, scroller, second, page);
+    ssd1306_scroller_copy_page(ssd, page, scroller->scratch[1]);
+    for (uint8_t x = 0; x < ssd->width; ++x)
+        scroller->scratch[0][x] = (scroller->scratch[0][x] & mask) | (scroller->scratch[1][x] & ~mask);
+    ssd1306_blit(ssd, scroller->scratch[0], ssd->width, 1, 0, page * 8);
+}
+
+// Volta ao início da lista e desenha todas as páginas
+void ssd1306_scroller_show(ssd1306_t *ssd, ssd1306_scroller_t *scroller)
+{
+    scroller->position = 0;
+    ssd1306_set_start_line(ssd, 0);
+    for (uint8_t page = 0; page < ssd->pages; ++page)
+        ssd1306_scroller_refresh_page(ssd, scroller, page);
+}
+
+// Rola um pixel: a linha da RAM que estava no topo passa para baixo e recebe o próximo pixel da lista
+void ssd1306_scroller_step(ssd1306_t *ssd, ssd1306_scroller_t *scroller)
+{
+    if (!ssd1306_scroller_scrolls(scroller))
+        return;
+
+    uint8_t leaving = scroller->position % ssd->height;
+    scroller->position++;
+    ssd1306_set_start_line(ssd, scroller->position % ssd->height);
+    ssd1306_scroller_refresh_page(ssd, scroller, leaving / 8);
+}
+
+// Redesenha as páginas em que a linha aparece agora (o conteúdo dela mudou)
+void ssd1306_scroller_refresh_row(ssd1306_t *ssd, ssd1306_scroller_t *scroller, int row)
+{
+    for (uint8_t page = 0; page < ssd->pages; ++page)
+    {
+        for (uint8_t bit = 0; bit < 8; bit += 7) // Uma página tem no máximo duas linhas: a do bit 0 e a do bit 7
+        {
+            if (ssd1306_scroller_row_at(ssd, scroller, page, bit) == row)
+            {
+                ssd1306_scroller_refresh_page(ssd, scroller, page);
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef SSD1306_VIEW_H
+#define SSD1306_VIEW_H
+
+#include "ssd1306.h"
+
+#define SSD1306_CELL_WIDTH 5 // Colunas de uma célula da grade (4 de desenho + 1 de espaço)
+
+// Glifos das células da grade, uma por item (6 linhas de altura dentro da página)
+typedef enum ssd1306_cell
+{
+    SSD1306_CELL_EMPTY,   // Contorno
+    SSD1306_CELL_FILLED,  // Preenchida
+    SSD1306_CELL_HATCHED, // Contorno com xadrez
+    SSD1306_CELL_DOT,     // Ponto central
+    SSD1306_CELL_COUNT
+} ssd1306_cell_t;
+
+// Desenha a linha "row" da lista na faixa y..y+7, incluindo o fundo
+typedef void (*ssd1306_row_fn)(ssd1306_t *ssd, void *ctx, int row, uint8_t y);
+
+// Lista de linhas de 8 pixels com rolagem por hardware. A RAM do display guarda a linha k da lista
+// na página k % 8 e a rolagem só muda a linha inicial da varredura; a cada pixel rolado, apenas a
+// página que sai pelo topo e entra por baixo é redesenhada (e enviada).
+typedef struct ssd1306_scroller
+{
+    ssd1306_row_fn draw_row;   // Desenho de uma linha
+    void *ctx;                 // Contexto de draw_row
+    int rows;                  // Linhas da lista
+    int cycle;                 // Linhas de uma volta: rows + 1 em branco se rola, as páginas da tela se cabe
+    uint32_t position;         // Pixel da lista no topo da tela (cresce sem voltar; a lista é circular)
+    uint8_t scratch[2][WIDTH]; // Páginas montadas quando duas linhas dividem a mesma página
+} ssd1306_scroller_t;
+
+void ssd1306_scroller_init(ssd1306_scroller_t *scroller, int rows, ssd1306_row_fn draw_row, void *ctx); // Prepara a lista
+bool ssd1306_scroller_scrolls(const ssd1306_scroller_t *scroller);                                    // Indica se a lista passa da tela
+void ssd1306_scroller_show(ssd1306_t *ssd, ssd1306_scroller_t *scroller);                             // Desenha a tela toda a partir do início
+void ssd1306_scroller_step(ssd1306_t *ssd, ssd1306_scroller_t *scroller);                             // Rola um pixel
+void ssd1306_scroller_refresh_row(ssd1306_t *ssd, ssd1306_scroller_t *scroller, int row);             // Redesenha uma linha se está visível
+void ssd1306_grid_cell(ssd1306_t *ssd, int index, ssd1306_cell_t cell, uint8_t top_page);             // Desenha a célula "index" da grade
+
+#endif // SSD1306_VIEW_H
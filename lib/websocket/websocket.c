@@ -0,0 +1,188 @@
+#include "websocket.h"
+#include <string.h>
+
+static const char ws_guid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"; // GUID fixo da RFC 6455
+static const char base64_table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+#define ROL32(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+
+// Processa um bloco de 64 bytes do SHA-1
+static void sha1_block(uint32_t state[5], const uint8_t block[64])
+{
+    uint32_t w[80];
+
+    for (int i = 0; i < 16; i++)
+        w[i] = ((uint32_t)block[i * 4] << 24) | ((uint32_t)block[i * 4 + 1] << 16) |
+               ((uint32_t)block[i * 4 + 2] << 8) | block[i * 4 + 3];
+    for (int i = 16; i < 80; i++)
+        w[i] = ROL32(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+
+    for (int i = 0; i < 80; i++)
+    {
+        uint32_t f, k;
+        if (i < 20)
+        {
+            f = (b & c) | (~b & d);
+            k = 0x5A827999;
+        }
+        else if (i < 40)
+        {
+            f = b ^ c ^ d;
+            k = 0x6ED9EBA1;
+        }
+        else if (i < 60)
+        {
+            f = (b & c) | (b & d) | (c & d);
+            k = 0x8F1BBCDC;
+        }
+        else
+        {
+            f = b ^ c ^ d;
+            k = 0xCA62C1D6;
+        }
+
+        uint32_t temp = ROL32(a, 5) + f + e + k + w[i];
+        e = d;
+        d = c;
+        c = ROL32(b, 30);
+        b = a;
+        a = temp;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+}
+
+// SHA-1 de uma mensagem curta (chave + GUID cabem em dois blocos)
+static void sha1(const uint8_t *data, size_t len, uint8_t digest[20])
+{
+    uint32_t state[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    uint8_t block[64];
+    size_t offset = 0;
+
+    while (len - offset >= 64)
+    {
+        sha1_block(state, data + offset);
+        offset += 64;
+    }
+
+    // Preenchimento: 0x80, zeros e o tamanho em bits (big-endian) no final do último bloco
+    size_t rest = len - offset;
+    memset(block, 0, sizeof(block));
+    memcpy(block, data + offset, rest);
+    block[rest] = 0x80;
+    if (rest >= 56)
+    {
+        sha1_block(state, block);
+        memset(block, 0, sizeof(block));
+    }
+
+    uint64_t bits = (uint64_t)len * 8;
+    for (int i = 0; i < 8; i++)
+        block[63 - i] = (uint8_t)(bits >> (i * 8));
+    sha1_block(state, block);
+
+    for (int i = 0; i < 5; i++)
+    {
+        digest[i * 4] = (uint8_t)(state[i] >> 24);
+        digest[i * 4 + 1] = (uint8_t)(state[i] >> 16);
+        digest[i * 4 + 2] = (uint8_t)(state[i] >> 8);
+        digest[i * 4 + 3] = (uint8_t)state[i];
+    }
+}
+
+// Calcula a Sec-WebSocket-Accept: base64(SHA-1(chave + GUID))
+void ws_accept_key(const char *key, char *accept)
+{
+    uint8_t input[WS_KEY_LEN + sizeof(ws_guid) - 1];
+    uint8_t digest[20];
+
+    memcpy(input, key, WS_KEY_LEN);
+    memcpy(input + WS_KEY_LEN, ws_guid, sizeof(ws_guid) - 1);
+    sha1(input, sizeof(input), digest);
+
+    // 20 bytes -> 28 caracteres base64 (o último grupo tem 2 bytes e um '=')
+    int out = 0;
+    for (int i = 0; i < 20; i += 3)
+    {
+        uint32_t group = (uint32_t)digest[i] << 16;
+        if (i + 1 < 20)
+            group |= (uint32_t)digest[i + 1] << 8;
+        if (i + 2 < 20)
+            group |= digest[i + 2];
+
+        accept[out++] = base64_table[(group >> 18) & 0x3F];
+        accept[out++] = base64_table[(group >> 12) & 0x3F];
+        accept[out++] = (i + 1 < 20) ? base64_table[(group >> 6) & 0x3F] : '=';
+        accept[out++] = (i + 2 < 20) ? base64_table[group & 0x3F] : '=';
+    }
+    accept[out] = '\0';
+}
+
+// Monta o cabeçalho de um quadro do servidor (sem máscara) e retorna o seu tamanho
+size_t ws_frame_header(uint8_t *header, uint8_t opcode, size_t len)
+{
+    header[0] = 0x80 | opcode; // FIN + opcode
+
+    if (len < 126)
+    {
+        header[1] = (uint8_t)len;
+        return 2;
+    }
+
+    header[1] = 126;
+    header[2] = (uint8_t)(len >> 8);
+    header[3] = (uint8_t)len;
+    return 4;
+}
+
+// Decodifica um quadro do cliente no início do buffer.
+// Retorna o total de bytes consumidos, 0 se o quadro ainda está incompleto, WS_PARSE_INVALID se não
+// tem máscara ou WS_PARSE_TOO_BIG se o quadro inteiro passa de max_frame bytes.
+int ws_parse_frame(uint8_t *buffer, size_t len, size_t max_frame, ws_frame_t *frame)
+{
+    if (len < 2)
+        return 0;
+
+    // Quadros do cliente são sempre mascarados (RFC 6455, seção 5.1)
+    if (!(buffer[1] & 0x80))
+        return WS_PARSE_INVALID;
+
+    size_t payload_len = buffer[1] & 0x7F;
+    size_t header_len = 2;
+
+    if (payload_len == 126)
+    {
+        if (len < 4)
+            return 0;
+        payload_len = ((size_t)buffer[2] << 8) | buffer[3];
+        header_len = 4;
+    }
+    else if (payload_len == 127)
+    {
+        return WS_PARSE_TOO_BIG; // Payloads de 64 bits nunca cabem no buffer da conexão
+    }
+
+    if (header_len + 4 + payload_len > max_frame)
+        return WS_PARSE_TOO_BIG;
+
+    if (len < header_len + 4 + payload_len)
+        return 0;
+
+    const uint8_t *mask = buffer + header_len;
+    uint8_t *payload = buffer + header_len + 4;
+    for (size_t i = 0; i < payload_len; i++)
+        payload[i] ^= mask[i & 3];
+
+    frame->opcode = buffer[0] & 0x0F;
+    frame->fin = (buffer[0] & 0x80) != 0;
+    frame->payload = payload;
+    frame->len = payload_len;
+
+    return (int)(header_len + 4 + payload_len);
+}
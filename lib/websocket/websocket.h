@@ -0,0 +1,35 @@
+#ifndef WEBSOCKET_H
+#define WEBSOCKET_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define WS_KEY_LEN 24        // Tamanho da Sec-WebSocket-Key em base64
+#define WS_ACCEPT_LEN 28     // Tamanho da Sec-WebSocket-Accept em base64
+#define WS_MAX_HEADER_LEN 4  // Cabeçalho de um quadro do servidor com payload < 64 KB
+
+#define WS_OPCODE_CONTINUATION 0x0
+#define WS_OPCODE_TEXT 0x1
+#define WS_OPCODE_BINARY 0x2
+#define WS_OPCODE_CLOSE 0x8
+#define WS_OPCODE_PING 0x9
+#define WS_OPCODE_PONG 0xA
+
+#define WS_PARSE_INVALID -1 // Quadro do cliente sem máscara
+#define WS_PARSE_TOO_BIG -2 // Quadro maior que o buffer da conexão
+
+// Quadro recebido do cliente, já desmascarado no próprio buffer
+typedef struct ws_frame
+{
+    uint8_t opcode;   // Tipo do quadro
+    bool fin;         // Último fragmento da mensagem
+    uint8_t *payload; // Dados do quadro
+    size_t len;       // Tamanho dos dados
+} ws_frame_t;
+
+void ws_accept_key(const char *key, char *accept);                                    // Calcula a Sec-WebSocket-Accept (28 caracteres + '\0')
+size_t ws_frame_header(uint8_t *header, uint8_t opcode, size_t len);                  // Monta o cabeçalho de um quadro do servidor
+int ws_parse_frame(uint8_t *buffer, size_t len, size_t max_frame, ws_frame_t *frame);   // Decodifica um quadro mascarado do cliente
+
+#endif // WEBSOCKET_H
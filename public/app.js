@@ -0,0 +1,124 @@
+// Renderiza as vagas a partir do estado em JSON ({"v":"boot-versão","s":[status...],"pcd":[0|1...],"zones":[...]})
+// e aplica as atualizações recebidas por /ws, /events ou, sem ambos, por consulta a /api/status.
+const STATUS_CLASS = ['disponivel', 'ocupada', 'reservada'];
+const STATUS_TEXT = ['Disponível', 'Ocupada', 'Reservada'];
+
+const state = { v: null, s: [], pcd: [], zones: [] };
+let ws = null;
+
+function createSpot(id) {
+    const pcd = state.pcd[id - 1] === 1;
+    const box = document.createElement('div');
+    box.id = 'v' + id;
+    box.className = pcd ? 'box pcd' : 'box';
+    box.innerHTML =
+        '<div class="status-indicator"></div>' +
+        '<div class="vaga-tipo">Vaga ' + id + (pcd ? ' - PCD' : '') + '</div>' +
+        '<p>' + (pcd ? 'Vaga exclusiva para PCD' : 'Vaga comum') + '</p>' +
+        '<p class="status-text"></p>' +
+        '<button class="btn-reservar">Reservar</button>';
+    box.querySelector('button').onclick = () => reserve(id);
+    return box;
+}
+
+function updateSpot(id) {
+    const box = document.getElementById('v' + id);
+    const status = state.s[id - 1];
+    if (!box) return;
+    box.querySelector('.status-indicator').className = 'status-indicator ' + STATUS_CLASS[status];
+    box.querySelector('.status-text').textContent = STATUS_TEXT[status];
+    box.querySelector('button').disabled = status !== 0;
+}
+
+function updateCounters() {
+    let normal = 0;
+    let pcd = 0;
+    state.s.forEach((status, i) => {
+        if (status === 0) state.pcd[i] ? pcd++ : normal++;
+    });
+    document.getElementById('vagas-normais').textContent = normal;
+    document.getElementById('vagas-pcd').textContent = pcd;
+}
+
+// Resumo por andar e zona a partir dos contadores enviados pelo servidor ({"n":nome,"f":andar,"c":[livres,ocupadas,reservadas]})
+function updateZones() {
+    const floors = new Map();
+    state.zones.forEach((zone) => {
+        if (!floors.has(zone.f)) floors.set(zone.f, []);
+        floors.get(zone.f).push(zone);
+    });
+    const lines = [...floors].map(([floor, zones]) => {
+        const free = zones.reduce((total, zone) => total + zone.c[0], 0);
+        const line = document.createElement('div');
+        line.textContent = (floor === 0 ? 'Térreo' : floor + 'º andar') + ': ' + free + ' livres (' +
+            zones.map((zone) => 'Zona ' + zone.n + ': ' + zone.c[0]).join(', ') + ')';
+        return line;
+    });
+    document.getElementById('zonas').replaceChildren(...lines);
+}
+
+// Estado completo reconstrói a grade; eventos individuais atualizam apenas a vaga alterada
+function apply(data) {
+    if (isStale(data.v)) return;
+    state.v = data.v;
+    if (Array.isArray(data.s)) {
+        state.s = data.s;
+        state.pcd = data.pcd || [];
+        state.zones = data.zones || [];
+        const grid = document.getElementById('vagas');
+        grid.replaceChildren(...state.s.map((_, i) => createSpot(i + 1)));
+        state.s.forEach((_, i) => updateSpot(i + 1));
+    } else {
+        state.s[data.id - 1] = data.s;
+        if (state.zones[data.z]) state.zones[data.z].c = data.zc;
+        updateSpot(data.id);
+    }
+    updateCounters();
+    updateZones();
+}
+
+// "v" é "boot-versão". No mesmo boot, uma resposta mais antiga que o estado exibido é descartada
+// (uma consulta a /api/status que termina depois de um evento mais novo).
+function isStale(v) {
+    if (typeof v !== 'string' || typeof state.v !== 'string') return false;
+    const [boot, version] = v.split('-');
+    const [shownBoot, shownVersion] = state.v.split('-');
+    return boot === shownBoot && Number(version) < Number(shownVersion);
+}
+
+function loadStatus() {
+    return fetch('/api/status').then((r) => r.json()).then(apply);
+}
+
+function reserve(id) {
+    if (ws && ws.readyState === WebSocket.OPEN) ws.send('reservar:' + id);
+    else fetch('/reservar-vaga-' + id).then(loadStatus);
+}
+
+// O primeiro evento de cada conexão é o estado completo. Em quedas transitórias o EventSource
+// reconecta sozinho (retry: 3000); só quando ele desiste (503 sem canais livres, resposta inválida)
+// a página consulta /api/status e tenta abrir o canal de novo mais tarde.
+function listenEvents() {
+    const es = new EventSource('/events');
+    es.onmessage = (m) => apply(JSON.parse(m.data));
+    es.onerror = () => {
+        if (es.readyState !== EventSource.CLOSED) return;
+        const poll = setInterval(loadStatus, 5000);
+        loadStatus();
+        setTimeout(() => {
+            clearInterval(poll);
+            listenEvents();
+        }, 30000);
+    };
+}
+
+try {
+    ws = new WebSocket('ws://' + location.host + '/ws');
+    ws.onmessage = (m) => apply(JSON.parse(m.data));
+    ws.onclose = () => {
+        ws = null;
+        listenEvents();
+    };
+} catch (e) {
+    listenEvents();
+}
@@ -1,19 +1,91 @@
 #ifndef HTML_DATA_H
 #define HTML_DATA_H
 
-const char *html_data =
+// Respostas HTTP geradas pelo firmware. A página, o CSS e o JS são estáticos e ficam no sistema de
+// arquivos do httpd (public/index.html, style.css e app.js, comprimidos por tools/makefsdata.py).
+
+// Cabeçalhos da API de status: ETag e tamanho do JSON
+static const char api_status_header[] =
+"HTTP/1.1 200 OK\r\n"
+"Content-Type: application/json\r\n"
+"Cache-Control: no-cache\r\n"
+"ETag: %s\r\n"
+"Content-Length: %u\r\n"
+"Connection: %s\r\n"
+"\r\n";
+
+// Cabeçalhos das demais respostas JSON (sem cache)
+static const char api_json_header[] =
+"HTTP/1.1 200 OK\r\n"
+"Content-Type: application/json\r\n"
+"Cache-Control: no-cache\r\n"
+"Content-Length: %u\r\n"
+"Connection: %s\r\n"
+"\r\n";
+
+// Cabeçalhos de respostas JSON de tamanho desconhecido, enviadas em chunks
+static const char api_chunked_header[] =
+"HTTP/1.1 200 OK\r\n"
+"Content-Type: application/json\r\n"
+"Cache-Control: no-cache\r\n"
+"Transfer-Encoding: chunked\r\n"
+"Connection: %s\r\n"
+"\r\n";
+
+// Resposta sem corpo quando o If-None-Match coincide com a versão atual
+static const char http_not_modified[] =
+"HTTP/1.1 304 Not Modified\r\n"
+"ETag: %s\r\n"
+"Connection: %s\r\n"
+"\r\n";
+
+// Abertura do canal de Server-Sent Events
+static const char sse_header[] =
 "HTTP/1.1 200 OK\r\n"
-"Content-Type: text/html\r\n"
-/* "Content-Length: 2220\r\n" // Substitua 1234 pelo tamanho real do conteúdo HTML
-"Connection: close\r\n" */
+"Content-Type: text/event-stream\r\n"
+"Cache-Control: no-cache\r\n"
+"Connection: keep-alive\r\n"
 "\r\n"
-"<!DOCTYPE html><html lang=\"pt-br\"><head><meta charset=\"UTF-8\"><title>Estacionamento Inteligente</title>"
-"<style>body{font-family:Arial,sans-serif;background:#f4f4f4;margin:0;padding:0;}.container{max-width:600px;margin:20px auto;padding:10px;background:#fff;border-radius:6px;box-shadow:0 2px 6px #0001;}h1{text-align:center;color:#222;}.content{display:grid;grid-template-columns:1fr 1fr;gap:10px;margin-top:20px;}.box{background:#e9e9e9;padding:10px;border-radius:4px;text-align:center;}.pcd{border:2px dashed #2196F3;background:#E3F2FD;position:relative;}.vaga-tipo{font-weight:bold;margin-bottom:6px;}.btn-reservar{background:#4CAF50;color:#fff;padding:6px 12px;border:none;border-radius:3px;cursor:pointer;margin-top:8px;}.btn-reservar:disabled{background:#bbb;cursor:not-allowed;}.status-indicator{width:14px;height:14px;border-radius:50%%;display:inline-block;margin-bottom:6px;}.disponivel{background:#4CAF50;}.ocupada{background:#f44336;}.reservada{background:#ff9800;}.status-text{font-size:0.9em;color:#555;margin:4px 0;}</style></head><body>"
-"<div class=\"container\"><h1>Estacionamento Inteligente</h1><div class=\"content\">"
-"<div class=\"box %s\"><div class=\"status-indicator %s\"></div><div class=\"vaga-tipo\">Vaga 1%s</div><p>%s</p><p class=\"status-text\">%s</p><form action=\"./reservar-vaga-1\"><button class=\"btn-reservar\" %s>Reservar</button></form></div>"
-"<div class=\"box %s\"><div class=\"status-indicator %s\"></div><div class=\"vaga-tipo\">Vaga 2%s</div><p>%s</p><p class=\"status-text\">%s</p><form action=\"./reservar-vaga-2\"><button class=\"btn-reservar\" %s>Reservar</button></form></div>"
-"<div class=\"box %s\"><div class=\"status-indicator %s\"></div><div class=\"vaga-tipo\">Vaga 3%s</div><p>%s</p><p class=\"status-text\">%s</p><form action=\"./reservar-vaga-3\"><button class=\"btn-reservar\" %s>Reservar</button></form></div>"
-"<div class=\"box %s\"><div class=\"status-indicator %s\"></div><div class=\"vaga-tipo\">Vaga 4%s</div><p>%s</p><p class=\"status-text\">%s</p><form action=\"./reservar-vaga-4\"><button class=\"btn-reservar\" %s>Reservar</button></form></div>"
-"</div></div><script>setTimeout(()=>{window.location.href = '/';},5000);</script></body></html>";
+"retry: 3000\n\n";
+
+// Resposta quando todos os canais SSE estão ocupados
+static const char sse_unavailable[] =
+"HTTP/1.1 503 Service Unavailable\r\n"
+"Content-Length: 0\r\n"
+"\r\n";
+
+// Resposta ao upgrade para WebSocket: Sec-WebSocket-Accept calculada a partir da chave do cliente
+static const char ws_upgrade_header[] =
+"HTTP/1.1 101 Switching Protocols\r\n"
+"Upgrade: websocket\r\n"
+"Connection: Upgrade\r\n"
+"Sec-WebSocket-Accept: %s\r\n"
+"\r\n";
+
+// Resposta às ações sobre as vagas: o navegador volta para a página
+static const char http_see_other[] =
+"HTTP/1.1 303 See Other\r\n"
+"Location: /\r\n"
+"Content-Length: 0\r\n"
+"\r\n";
+
+// Requisição malformada ou upgrade sem Sec-WebSocket-Key válida
+static const char http_bad_request[] =
+"HTTP/1.1 400 Bad Request\r\n"
+"Content-Length: 0\r\n"
+"\r\n";
+
+// Arquivo estático pedido por um cliente que recusa gzip: os arquivos só existem comprimidos
+static const char http_not_acceptable[] =
+"HTTP/1.1 406 Not Acceptable\r\n"
+"Vary: Accept-Encoding\r\n"
+"Content-Length: 0\r\n"
+"\r\n";
+
+// Rota inexistente ou vaga fora do intervalo
+static const char http_not_found[] =
+"HTTP/1.1 404 Not Found\r\n"
+"Content-Length: 0\r\n"
+"\r\n";
 
 #endif // HTML_DATA_H
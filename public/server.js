@@ -9,9 +9,7 @@ const app = express();
 const PORT = process.env.PORT || 3000;
 const HOST = process.env.HOST || "localhost";
 
-app.get("/", (req, res) => {
-  res.sendFile(path.join(__dirname, 'index.html'));
-});
+app.use(express.static(__dirname));
 
 app.listen(PORT, () => {
   console.log(`Server is running at http://${HOST}:${PORT}`);
@@ -1,4 +1,7 @@
+#include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "pico/stdlib.h"
 #include "pico/cyw43_arch.h" // Biblioteca para arquitetura Wi-Fi da Pico com CYW43
@@ -6,19 +9,32 @@
 #include "hardware/pio.h"
 #include "hardware/timer.h"
 #include "hardware/clocks.h"
+#include "hardware/flash.h"
+#include "pico/flash.h" // flash_safe_execute: programa a flash com as interrupções desligadas
+#include "pico/rand.h"  // get_rand_32: identificador do boot nas versões do estado
 // #include "pico/bootrom.h" // Biblioteca para inicialização do bootrom
 
 #include "lwip/pbuf.h"  // Lightweight IP stack - manipulação de buffers de pacotes de rede
 #include "lwip/tcp.h"   // Lightweight IP stack - fornece funções e estruturas para trabalhar com o protocolo TCP
 #include "lwip/netif.h" // Lightweight IP stack - fornece funções e estruturas para trabalhar com interfaces de rede (netif)
+#include "lwip/apps/fs.h" // Lightweight IP stack - arquivos estáticos comprimidos gerados por tools/makefsdata.py
 #include "lwipopts.h"   // Lightweight IP stack - O lwIP é uma implementação independente do conjunto de protocolos TCP/IP
 
 #include "lib/ssd1306/ssd1306.h"
 #include "lib/ssd1306/display.h"
+#include "lib/ssd1306/view.h"
 #include "lib/led/led.h"
 #include "lib/button/button.h"
 #include "lib/ws2812b/ws2812b.h"
 #include "lib/buzzer/buzzer.h"
+#include "lib/websocket/websocket.h"
+#include "lib/http/http_parser.h"
+#include "lib/http/http_router.h"
+#include "lib/parking/parking.h"
+#include "lib/parking/expiry.h"
+#include "lib/parking/journal.h"
+#include "lib/parking/flashlog.h"
+#include "lib/parking/analytics.h"
 #include "config/wifi_config.h"
 #include "public/html_data.h"
 
@@ -29,14 +45,71 @@
 #define CYW43_LED_PIN CYW43_WL_GPIO_LED_PIN // GPIO do CI CYW43
 #define PARKING_LOT_SIZE 4                  // Tamanho do estacionamento
 #define LED_MATRIX_PIN 7                    // GPIO da matriz de LEDs
+#define MAX_HTTP_CONNS 6                    // Conexões HTTP simultâneas (keep-alive)
+#define HTTP_IDLE_TIMEOUT_MS 10000          // Conexões HTTP ociosas por mais tempo são encerradas
+#define HTTP_POLL_INTERVAL 4                // Intervalo do tcp_poll em unidades de 500ms
+#define HTTP_CHUNKED_BODY_MAX 1024          // Maior corpo de /api/events por resposta (cópias no heap do lwIP)
+#define MAX_SSE_CLIENTS 4                   // Conexões simultâneas em /events
+#define SSE_KEEPALIVE_INTERVAL 10           // Intervalo do comentário de keepalive SSE em unidades de 500ms
+#define SSE_MAX_RETRANSMITS 2               // Retransmissões sem confirmação até descartar um cliente SSE
+#define MAX_WS_CLIENTS 4                    // Conexões simultâneas em /ws
+#define WS_RX_BUFFER_SIZE 128               // Buffer de recepção por conexão WebSocket
+#define RESERVATION_TIMEOUT_MS 10000        // Tempo até uma reserva comum expirar
+#define RESERVATION_PCD_TIMEOUT_MS 10000    // Tempo até a reserva de uma vaga PCD expirar
+#define JOURNAL_CAPACITY 128                // Transições guardadas no diário (potência de 2)
+#define PARKING_FLOORS 2                    // Andares do estacionamento
+#define ANALYTICS_HALF_LIFE_MS 3600000      // Meia-vida da utilização com decaimento (1 hora)
+#define FLASH_LOG_SECTORS 8                 // Setores no fim da flash usados em rodízio pelo log das vagas
+#define FLASH_LOG_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_LOG_SECTORS * FLASH_SECTOR_SIZE)
+#define FLASH_LOG_POLL_MS 100               // Intervalo de leitura do diário pela tarefa da flash
+#define FLASH_LOG_FLUSH_MS 1000             // Registros pendentes esperam no máximo isso para ir à flash
+#define DISPLAY_NOTIFY_FLUSH 1              // Índice da notificação de fim do envio ao display (0: vagas alteradas)
+#define DISPLAY_PAGE_MS 5000                // Tempo de cada tela fixa do display (resumo e zonas)
+#define DISPLAY_SCROLL_MS 40                // Intervalo entre os pixels da rolagem da lista de vagas
+#define DISPLAY_GRID_PAGE 2                 // Primeira página da grade de vagas na tela de uma zona
+#define DISPLAY_GRID_CELLS ((WIDTH / SSD1306_CELL_WIDTH) * (SSD1306_MAX_PAGES - DISPLAY_GRID_PAGE)) // Vagas por tela de zona
+
+// Consumidores das alterações das vagas; cada um tem o seu conjunto de vagas pendentes
+typedef enum output_consumer
+{
+    OUTPUT_DISPLAY,
+    OUTPUT_LED_MATRIX,
+    OUTPUT_BUZZER,
+    OUTPUT_WEB,
+    OUTPUT_COUNT
+} output_consumer_t;
+
+// Telas do display, mostradas em sequência
+typedef enum display_view
+{
+    DISPLAY_VIEW_SUMMARY, // Total de vagas livres e uma linha por zona
+    DISPLAY_VIEW_ZONE,    // Grade de uma zona, uma célula por vaga
+    DISPLAY_VIEW_LIST,    // Todas as vagas, roladas pelo hardware do display
+} display_view_t;
+
+typedef struct http_conn
+{
+    struct tcp_pcb *pcb;     // Conexão HTTP (NULL se o slot está livre)
+    http_parser_t parser;    // Parser incremental da requisição em andamento
+    uint32_t last_active_ms; // Última atividade, para expiração e escolha do LRU
+    bool keep_alive;         // Manter a conexão aberta após a resposta atual
+    bool write_failed;       // Um tcp_write da resposta atual foi recusado (resposta truncada)
+} http_conn_t;
+
+typedef struct ws_client
+{
+    struct tcp_pcb *pcb;           // Conexão WebSocket (NULL se o slot está livre)
+    uint8_t rx[WS_RX_BUFFER_SIZE]; // Bytes recebidos ainda não processados
+    uint16_t rx_len;               // Quantidade de bytes no buffer
+} ws_client_t;
 
-typedef struct parking_lot
+// Parâmetros de uma operação na flash executada por flash_safe_execute
+typedef struct flash_io_op
 {
-    uint8_t id;                        // ID do estacionamento
-    uint8_t status;                    // Status do estacionamento (0 - livre, 1 - ocupado, 2 - reservado)
-    TickType_t reservation_start_time; // Hora de início da reserva
-    bool is_pcd;                       // Se o estacionamento é PCD (Pessoa com Deficiência)
-} parking_lot_t;
+    uint32_t offset; // Offset dentro da região do log
+    const void *src; // Página a programar
+    size_t len;      // Tamanho da página
+} flash_io_op_t;
 
 int init_cyw43_arch();                                                                    // Inicializa a arquitetura do cyw43
 int init_webserver(struct tcp_pcb **server);                                              // Inicializa o servidor web
@@ -46,40 +119,195 @@ void vInputControlTask(void *pvParameters);
 void vLedMatrixTask(void *pvParameters);                                                  // Tarefa da matriz de LEDs
 void vReservationTimeoutTask(void *pvParameters);                                         // Tarefa de reserva
 void vDisplayTask(void *pvParameters);                                                    // Tarefa do display
+static void display_flush_done(void *ctx);                                                // IRQ de fim do envio ao display
 void vLedRGBTask(void *pvParameters);                                                     // Tarefa do LED
 void vBuzzerTask(void *pvParameters);                                                     // Tarefa do buzzer
+void vFlashLogTask(void *pvParameters);                                                   // Tarefa de gravação do estado na flash
 static err_t tcp_server_accept(void *arg, struct tcp_pcb *newpcb, err_t err);             // Função de callback ao aceitar conexões TCP
 static err_t tcp_server_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err); // Função de callback para processar requisições HTTP
-void user_request(char **request);                                                        // Tratamento do request do usuário
+static void tcp_server_err(void *arg, err_t err);                                         // Callback de erro das conexões HTTP
+static err_t tcp_server_poll(void *arg, struct tcp_pcb *tpcb);                            // Encerra conexões HTTP ociosas
+static err_t close_http_conn(http_conn_t *conn);                                          // Encerra uma conexão HTTP e libera o slot
+static err_t abort_http_conn(http_conn_t *conn);                                          // Aborta uma conexão HTTP com resposta truncada
+static bool http_write(http_conn_t *conn, const void *data, uint16_t len, uint8_t flags); // tcp_write que registra a falha na conexão
+static void detach_http_conn(http_conn_t *conn);                                          // Libera o slot de uma conexão promovida a SSE/WebSocket
+static err_t handle_http_request(http_conn_t *conn);                                      // Responde uma requisição já analisada
+bool reserve_parking_lot(int index, journal_source_t source);                             // Reserva uma vaga livre
+bool occupy_parking_lot(int index, journal_source_t source);                              // Marca uma vaga livre ou reservada como ocupada
+bool release_parking_lot(int index, journal_source_t source);                             // Libera uma vaga
+static bool send_static_file(http_conn_t *conn, const char *path);                        // Envia um arquivo do sistema de arquivos do httpd
+static void route_page(void *ctx, int id);                                                // GET /
+static void route_reserve(void *ctx, int id);                                             // GET /reservar-vaga-N
+static void route_occupy(void *ctx, int id);                                              // GET /ocupar-vaga-N
+static void route_release(void *ctx, int id);                                             // GET /liberar-vaga-N
+static void route_release_all(void *ctx, int id);                                         // GET /admin/liberar-todas
+static void route_api_status(void *ctx, int id);                                          // GET /api/status
+static void route_next_free(void *ctx, int id);                                           // GET /api/next-free?pcd=0|1
+static void route_journal(void *ctx, int id);                                             // GET /api/events?since=seq
+static void route_stats(void *ctx, int id);                                               // GET /api/stats
+static bool send_chunk(http_conn_t *conn, char *buffer, int prefix, int len);              // Envia um chunk da transferência chunked
+static void route_events(void *ctx, int id);                                              // GET /events
+static void route_websocket(void *ctx, int id);                                           // GET /ws
 void notify_output_tasks();                                                               // Verifica se há notificações pendentes
-
-static volatile parking_lot_t parking_lots[PARKING_LOT_SIZE]; // Array de estruturas para armazenar o status do estacionamento
-static volatile int8_t current_parking_lot = 0;               // Vaga de estacionamento atual
+static void render_status_json();                                                         // Renderiza o estado das vagas no cache de resposta
+static int json_cache_printf(int pos, const char *format, ...);                           // Acrescenta texto formatado ao cache sem passar do fim
+static int json_cache_putc(int pos, char c);                                              // Acrescenta um caractere ao cache sem passar do fim
+static void send_api_status(http_conn_t *conn);                                           // Responde GET /api/status com ETag
+static bool open_sse_stream(http_conn_t *conn);                                           // Registra um cliente de Server-Sent Events
+static err_t tcp_sse_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err);    // Callback de recepção das conexões SSE
+static err_t tcp_sse_poll(void *arg, struct tcp_pcb *tpcb);                               // Keepalive das conexões SSE; descarta clientes que sumiram
+static void remove_sse_client(struct tcp_pcb *tpcb);                                      // Remove um cliente de Server-Sent Events
+static void tcp_sse_err(void *arg, err_t err);                                            // Callback de erro das conexões SSE
+static bool open_websocket(http_conn_t *conn);                                            // Faz o upgrade da conexão para WebSocket
+static err_t tcp_ws_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err);     // Callback de recepção das conexões WebSocket
+static void tcp_ws_err(void *arg, err_t err);                                             // Callback de erro das conexões WebSocket
+static err_t ws_send(struct tcp_pcb *tpcb, uint8_t opcode, const void *payload, size_t len); // Envia um quadro WebSocket
+static void push_state_events();                                                          // Envia as vagas alteradas aos clientes SSE e WebSocket
+static uint32_t reservation_timeout_ms(int index);                                        // Tempo de reserva da classe da vaga
+static void take_parking_snapshot(parking_snapshot_t *snapshot, uint32_t *words);         // Copia o estado das vagas sem transições pela metade
+static void mark_spot_dirty(int index);                                                   // Marca a vaga como alterada para todos os consumidores
+static bool take_dirty_spots(output_consumer_t consumer, uint32_t *dirty);                // Retira as vagas pendentes de um consumidor
+static int next_dirty_spot(uint32_t *dirty);                                              // Próxima vaga pendente (-1 se não houver)
+static uint32_t display_next_view(void);                                                  // Avança para a próxima tela do display e retorna sua duração
+static void display_show(void);                                                           // Desenha a tela atual do display inteira
+static void display_update(uint32_t *dirty);                                              // Redesenha na tela atual o que mudou nas vagas
+static void display_draw_summary(void);                                                   // Desenha os totais da tela de resumo que mudaram
+static void display_draw_zone_counts(void);                                               // Desenha os totais da zona se mudaram
+static void display_draw_cell(int spot);                                                  // Desenha a célula da vaga se está na grade da tela
+static void display_draw_list_row(ssd1306_t *ssd, void *ctx, int row, uint8_t y);         // Desenha uma linha da lista de vagas
+static void restore_parking_state();                                                      // Recupera o estado das vagas gravado na flash
+static bool sync_flash_log();                                                             // Grava o estado atual completo no log da flash
+static bool flash_io_read(void *ctx, uint32_t offset, void *dst, size_t len);             // Lê a região do log pela XIP
+static bool flash_io_program(void *ctx, uint32_t offset, const void *src, size_t len);    // Programa uma página da região do log
+static bool flash_io_erase(void *ctx, uint32_t offset);                                   // Apaga um setor da região do log
+
+// Zonas do estacionamento, em ordem de primeira vaga e cobrindo todas as vagas
+static const parking_zone_t parking_zones[] = {
+    {.name = "A", .first = 0, .count = 2, .floor = 0}, // Térreo
+    {.name = "B", .first = 2, .count = 2, .floor = 1}, // 1º andar
+};
+#define PARKING_ZONES (sizeof(parking_zones) / sizeof(parking_zones[0]))
+
+static const uint16_t parking_pcd_spots[] = {PARKING_LOT_SIZE - 1}; // Vagas exclusivas para PCD
+
+static parking_word_t parking_words[PARKING_STORE_WORDS(PARKING_LOT_SIZE)];                                 // Status e PCD das vagas, 4 bits por vaga
+static uint32_t parking_since[PARKING_LOT_SIZE];                                                          // Instante da última transição de cada vaga
+static parking_word_t parking_free_bits[PARKING_CLASS_COUNT][PARKING_BITMAP_WORDS(PARKING_LOT_SIZE)];     // Vagas livres por classe
+static parking_word_t parking_free_summary[PARKING_CLASS_COUNT][PARKING_SUMMARY_WORDS(PARKING_LOT_SIZE)]; // Palavras não vazias do bitmap
+static parking_counter_t parking_zone_counts[PARKING_ZONES];                                              // Vagas por status em cada zona
+static parking_counter_t parking_floor_counts[PARKING_FLOORS];                                            // Vagas por status em cada andar
+
+// Estado das vagas, alterado apenas por transições atômicas
+static parking_store_t parking = {
+    .words = parking_words,
+    .since_ms = parking_since,
+    .free_bits = {parking_free_bits[PARKING_CLASS_REGULAR], parking_free_bits[PARKING_CLASS_PCD]},
+    .free_summary = {parking_free_summary[PARKING_CLASS_REGULAR], parking_free_summary[PARKING_CLASS_PCD]},
+    .size = PARKING_LOT_SIZE,
+    .zones = parking_zones,
+    .zone_count = PARKING_ZONES,
+    .floor_count = PARKING_FLOORS,
+    .zone_counts = parking_zone_counts,
+    .floor_counts = parking_floor_counts,
+};
+static volatile int8_t current_parking_lot = 0;     // Vaga de estacionamento atual
+static _Atomic uint32_t parking_state_version = 0;  // Versão do estado, incrementada a cada alteração das vagas
+
+static uint16_t expiry_slots[PARKING_LOT_SIZE];    // Heap de prazos das reservas
+static uint16_t expiry_pos[PARKING_LOT_SIZE];      // Posição de cada vaga no heap
+static uint32_t expiry_deadline[PARKING_LOT_SIZE]; // Prazo da reserva de cada vaga
+static expiry_heap_t reservation_expiry;           // Prazos das reservas, protegidos por seção crítica
+
+static journal_slot_t journal_slots[JOURNAL_CAPACITY]; // Anel do diário de transições
+static journal_t parking_journal;                      // Diário de transições das vagas
+
+static parking_word_t dirty_spots[OUTPUT_COUNT][PARKING_BITMAP_WORDS(PARKING_LOT_SIZE)]; // Vagas alteradas pendentes de cada consumidor
+
+static analytics_spot_t analytics_spots[PARKING_LOT_SIZE]; // Estatísticas de cada vaga
+static analytics_zone_t analytics_zones[PARKING_ZONES];    // Estatísticas de cada zona
+static analytics_t parking_analytics;                      // Estatísticas de uso, protegidas por seção crítica
+
+// Estado da tarefa do display, fora da pilha da tarefa
+static struct
+{
+    ssd1306_t ssd;
+    parking_snapshot_t snapshot;                              // Cópia do estado das vagas usada no desenho
+    uint32_t words[PARKING_STORE_WORDS(PARKING_LOT_SIZE)];     // Palavras da cópia
+    uint16_t zone_counts[PARKING_ZONES][PARKING_STATUS_COUNT]; // Contadores por zona da cópia
+    display_view_t view;                                      // Tela atual
+    uint8_t zone;                                             // Zona da tela de grade
+    uint16_t chunk;                                           // Parte da zona na tela (zonas maiores que a grade)
+    ssd1306_scroller_t list;                                  // Lista de vagas rolada por hardware
+    int last_free, last_pcd;                                  // Totais desenhados no resumo (-1: redesenhar)
+    uint16_t last_zone[PARKING_ZONES][PARKING_STATUS_COUNT];  // Contadores desenhados de cada zona
+
+    // Rótulos fixos renderizados uma vez; depois cada desenho é uma cópia de colunas
+    uint8_t title_columns[WIDTH], label_columns[WIDTH / 2], status_columns[PARKING_STATUS_COUNT + 1][WIDTH];
+    ssd1306_run_t title_run, label_run, status_runs[PARKING_STATUS_COUNT + 1];
+} display;
+
+static const flashlog_io_t flash_io = {
+    .read = flash_io_read,
+    .program = flash_io_program,
+    .erase = flash_io_erase,
+};
+static uint8_t flash_log_state[PARKING_LOT_SIZE]; // Status de cada vaga como está na flash
+static flashlog_t flash_log;                      // Log das transições no fim da flash (usado só pela tarefa da flash após o boot)
+
+static char json_cache[80 + 4 * PARKING_LOT_SIZE + 56 * PARKING_ZONES + 24 * PARKING_FLOORS]; // Estado das vagas em JSON compacto
+static uint16_t json_cache_len = 0;                // Tamanho do JSON em cache
+static uint32_t json_cache_version = 0;            // Versão do estado usada na última renderização
+static uint32_t boot_id = 0;                       // Aleatório por boot: a versão recomeça em 0 com o estado restaurado da flash
+static bool json_cache_valid = false;              // Indica se o cache já foi renderizado
+
+static http_conn_t http_conns[MAX_HTTP_CONNS];       // Conexões HTTP e o estado do parser de cada uma
+
+// Tabela de rotas: o número da vaga é extraído do caminho junto com a comparação do prefixo
+static const http_route_t http_routes[] = {
+    {HTTP_METHOD_GET, "/", false, route_page},
+    {HTTP_METHOD_GET, "/reservar-vaga-", true, route_reserve},
+    {HTTP_METHOD_GET, "/ocupar-vaga-", true, route_occupy},
+    {HTTP_METHOD_GET, "/liberar-vaga-", true, route_release},
+    {HTTP_METHOD_GET, "/api/status", false, route_api_status},
+    {HTTP_METHOD_GET, "/api/next-free", false, route_next_free},
+    {HTTP_METHOD_GET, "/api/events", false, route_journal},
+    {HTTP_METHOD_GET, "/api/stats", false, route_stats},
+    {HTTP_METHOD_GET, "/events", false, route_events},
+    {HTTP_METHOD_GET, "/ws", false, route_websocket},
+    {HTTP_METHOD_GET, "/admin/liberar-todas", false, route_release_all},
+};
+static struct tcp_pcb *sse_clients[MAX_SSE_CLIENTS]; // Conexões abertas em /events
+static ws_client_t ws_clients[MAX_WS_CLIENTS];       // Conexões abertas em /ws
 
 TaskHandle_t xDisplayTaskHandle = NULL;
 TaskHandle_t xLedRGBTaskHandle = NULL;
 TaskHandle_t xLedMatrixTaskHandle = NULL;
 TaskHandle_t xBuzzerTaskHandle = NULL;
+TaskHandle_t xWebServerTaskHandle = NULL;
+TaskHandle_t xReservationTimeoutTaskHandle = NULL;
 
 int main()
 {
     stdio_init_all();
+    boot_id = get_rand_32(); // Versões do estado de boots diferentes nunca coincidem
     init_parking_lots(); // Inicializa o estacionamento
 
     xTaskCreate(vWebServerTask, "WebServerTask", 2 * configMINIMAL_STACK_SIZE,
-                NULL, tskIDLE_PRIORITY + 2, NULL);
+                NULL, tskIDLE_PRIORITY + 2, &xWebServerTaskHandle);
     xTaskCreate(vInputControlTask, "InputControlTask", configMINIMAL_STACK_SIZE,
                 NULL, tskIDLE_PRIORITY + 2, NULL);
     xTaskCreate(vLedMatrixTask, "LedMatrixTask", configMINIMAL_STACK_SIZE,
                 NULL, tskIDLE_PRIORITY + 2, &xLedMatrixTaskHandle);
     xTaskCreate(vReservationTimeoutTask, "ReservationTimeoutTask", configMINIMAL_STACK_SIZE,
-                NULL, tskIDLE_PRIORITY + 1, NULL);
+                NULL, tskIDLE_PRIORITY + 1, &xReservationTimeoutTaskHandle);
     xTaskCreate(vDisplayTask, "DisplayTask", configMINIMAL_STACK_SIZE,
                 NULL, tskIDLE_PRIORITY + 1, &xDisplayTaskHandle);
     xTaskCreate(vLedRGBTask, "LedRGBTask", configMINIMAL_STACK_SIZE,
                 NULL, tskIDLE_PRIORITY, &xLedRGBTaskHandle);
     xTaskCreate(vBuzzerTask, "BuzzerTask", configMINIMAL_STACK_SIZE,
                 NULL, tskIDLE_PRIORITY, &xBuzzerTaskHandle);
+    xTaskCreate(vFlashLogTask, "FlashLogTask", configMINIMAL_STACK_SIZE,
+                NULL, tskIDLE_PRIORITY, NULL);
 
     xTaskNotifyGive(xLedMatrixTaskHandle); // Notifica a tarefa da matriz de LEDs
     xTaskNotifyGive(xDisplayTaskHandle);   // Notifica a tarefa do display
@@ -94,174 +322,1240 @@ int init_cyw43_arch()
 {
     while (cyw43_arch_init())
     {
-        // printf("Falha ao inicializar Wi-Fi\n");
-        sleep_ms(100);
-        return -1;
+        // printf("Falha ao inicializar Wi-Fi\n");
+        sleep_ms(100);
+        return -1;
+    }
+
+    // GPIO do CI CYW43 em nível baixo
+    cyw43_arch_gpio_put(CYW43_LED_PIN, 0);
+
+    // Ativa o Wi-Fi no modo Station, de modo a que possam ser feitas ligações a outros pontos de acesso Wi-Fi.
+    cyw43_arch_enable_sta_mode();
+
+    // Conectar à rede WiFI - fazer um loop até que esteja conectado
+    // printf("Conectando ao Wi-Fi...\n");
+    while (cyw43_arch_wifi_connect_timeout_ms(WIFI_SSID, WIFI_PASSWORD, CYW43_AUTH_WPA2_AES_PSK, 20000))
+    {
+        // printf("Falha ao conectar ao Wi-Fi\n");
+        sleep_ms(100);
+        return -1;
+    }
+    // printf("Conectado ao Wi-Fi\n");
+
+    // Caso seja a interface de rede padrão - imprimir o IP do dispositivo.
+    if (netif_default)
+    {
+        printf("IP do dispositivo: %s\n", ipaddr_ntoa(&netif_default->ip_addr));
+    }
+
+    return 0;
+}
+
+// Inicializa o servidor web
+int init_webserver(struct tcp_pcb **server)
+{
+    // vincula um PCB TCP a um endereço IP e porta específicos
+    if (tcp_bind(*server, IP_ADDR_ANY, 80) != ERR_OK)
+    {
+        // printf("Falha ao associar servidor TCP à porta 80\n");
+        return -1;
+    }
+
+    // Coloca o PCB TCP em modo de escuta
+    *server = tcp_listen(*server); // Atualiza o ponteiro original
+    if (*server == NULL)
+    {
+        // printf("Falha ao criar servidor de escuta\n");
+        return -1;
+    }
+
+    // Define função de callback para aceitar conexões
+    tcp_accept(*server, tcp_server_accept);
+    // printf("Servidor ouvindo na porta 80\n");
+
+    return 0;
+}
+
+// Inicializa o estacionamento
+void init_parking_lots()
+{
+    parking_init(&parking);                                // Todas as vagas livres
+    for (size_t i = 0; i < sizeof(parking_pcd_spots) / sizeof(parking_pcd_spots[0]); i++)
+        parking_set_pcd(&parking, parking_pcd_spots[i], true);
+
+    expiry_init(&reservation_expiry, expiry_slots, expiry_pos, expiry_deadline, PARKING_LOT_SIZE);
+    journal_init(&parking_journal, journal_slots, JOURNAL_CAPACITY);
+
+    restore_parking_state(); // Vagas ocupadas ou reservadas antes do reset
+
+    // Estatísticas partem do estado recuperado, sem contar a recuperação como eventos
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    analytics_init(&parking_analytics, analytics_spots, PARKING_LOT_SIZE,
+                   analytics_zones, PARKING_ZONES, ANALYTICS_HALF_LIFE_MS, now);
+    for (int i = 0; i < PARKING_LOT_SIZE; i++)
+        analytics_seed(&parking_analytics, i, parking_zone_of(&parking, i), parking_get_status(&parking, i), now);
+}
+
+// Recupera o estado gravado na flash. Roda antes do escalonador, então as transições vão direto
+// para o armazenamento, sem diário nem notificações; as tarefas de saída desenham tudo ao iniciar.
+static void restore_parking_state()
+{
+    flashlog_init(&flash_log, &flash_io, FLASH_LOG_SECTORS, flash_log_state, PARKING_LOT_SIZE);
+    if (!flashlog_mount(&flash_log))
+        return; // Região vazia: todas as vagas livres
+
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    for (int i = 0; i < PARKING_LOT_SIZE; i++)
+    {
+        parking_status_t status = flash_log_state[i];
+
+        if (status == PARKING_OCCUPIED || status == PARKING_RESERVED)
+            parking_transition(&parking, i, PARKING_FROM(PARKING_FREE), status, now, NULL);
+        else
+            flash_log_state[i] = PARKING_FREE; // Valor desconhecido volta como livre
+
+        // A reserva recomeça a contar a partir do boot
+        if (status == PARKING_RESERVED)
+            expiry_schedule(&reservation_expiry, i, now + reservation_timeout_ms(i));
+    }
+}
+
+// Lê a região do log direto pela XIP
+static bool flash_io_read(void *ctx, uint32_t offset, void *dst, size_t len)
+{
+    memcpy(dst, (const void *)(XIP_BASE + FLASH_LOG_OFFSET + offset), len);
+    return true;
+}
+
+static void flash_io_do_program(void *param)
+{
+    const flash_io_op_t *op = param;
+    flash_range_program(FLASH_LOG_OFFSET + op->offset, op->src, op->len);
+}
+
+static void flash_io_do_erase(void *param)
+{
+    const flash_io_op_t *op = param;
+    flash_range_erase(FLASH_LOG_OFFSET + op->offset, FLASH_SECTOR_SIZE);
+}
+
+// Programa uma página da região do log (a XIP fica indisponível durante a operação)
+static bool flash_io_program(void *ctx, uint32_t offset, const void *src, size_t len)
+{
+    flash_io_op_t op = {.offset = offset, .src = src, .len = len};
+    return flash_safe_execute(flash_io_do_program, &op, UINT32_MAX) == PICO_OK;
+}
+
+// Apaga um setor da região do log
+static bool flash_io_erase(void *ctx, uint32_t offset)
+{
+    flash_io_op_t op = {.offset = offset};
+    return flash_safe_execute(flash_io_do_erase, &op, UINT32_MAX) == PICO_OK;
+}
+
+// Copia o estado atual das vagas para o log e o compacta em um setor novo
+static bool sync_flash_log()
+{
+    uint32_t words[PARKING_STORE_WORDS(PARKING_LOT_SIZE)];
+    parking_snapshot_t snapshot = {0};
+    take_parking_snapshot(&snapshot, words);
+
+    for (int i = 0; i < PARKING_LOT_SIZE; i++)
+        flash_log_state[i] = parking_snapshot_status(&snapshot, i);
+
+    return flashlog_compact(&flash_log);
+}
+
+// Função de callback ao aceitar conexões TCP
+static err_t tcp_server_accept(void *arg, struct tcp_pcb *newpcb, err_t err)
+{
+    // printf("Conexão aceita\n");
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    http_conn_t *conn = NULL;
+
+    for (int i = 0; i < MAX_HTTP_CONNS && conn == NULL; i++)
+    {
+        if (http_conns[i].pcb == NULL)
+            conn = &http_conns[i];
+    }
+
+    // Pool cheio: recupera o slot da conexão usada há mais tempo
+    if (conn == NULL)
+    {
+        conn = &http_conns[0];
+        for (int i = 1; i < MAX_HTTP_CONNS; i++)
+        {
+            if ((now - http_conns[i].last_active_ms) > (now - conn->last_active_ms))
+                conn = &http_conns[i];
+        }
+        close_http_conn(conn);
+    }
+
+    conn->pcb = newpcb;
+    conn->last_active_ms = now;
+    conn->keep_alive = true;
+    http_parser_init(&conn->parser);
+
+    tcp_arg(newpcb, conn);
+    tcp_recv(newpcb, tcp_server_recv);
+    tcp_err(newpcb, tcp_server_err);
+    tcp_poll(newpcb, tcp_server_poll, HTTP_POLL_INTERVAL);
+    return ERR_OK;
+}
+
+// Callback de erro das conexões HTTP: o PCB já foi liberado pelo lwIP
+static void tcp_server_err(void *arg, err_t err)
+{
+    http_conn_t *conn = (http_conn_t *)arg;
+    if (conn)
+        conn->pcb = NULL;
+}
+
+// Chamado periodicamente pelo lwIP: encerra conexões keep-alive ociosas
+static err_t tcp_server_poll(void *arg, struct tcp_pcb *tpcb)
+{
+    http_conn_t *conn = (http_conn_t *)arg;
+    if (!conn || conn->pcb != tpcb)
+        return ERR_OK;
+
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    if ((now - conn->last_active_ms) > HTTP_IDLE_TIMEOUT_MS)
+        return close_http_conn(conn);
+
+    return ERR_OK;
+}
+
+// Encerra uma conexão HTTP e libera o slot. Retorna ERR_ABRT se foi preciso abortar o PCB.
+static err_t close_http_conn(http_conn_t *conn)
+{
+    struct tcp_pcb *tpcb = conn->pcb;
+    conn->pcb = NULL;
+    if (!tpcb)
+        return ERR_OK;
+
+    tcp_arg(tpcb, NULL);
+    tcp_recv(tpcb, NULL);
+    tcp_err(tpcb, NULL);
+    tcp_poll(tpcb, NULL, 0);
+
+    if (tcp_close(tpcb) != ERR_OK)
+    {
+        tcp_abort(tpcb);
+        return ERR_ABRT;
+    }
+    return ERR_OK;
+}
+
+// Aborta a conexão (RST) e libera o slot: o cliente não recebe uma resposta truncada como se
+// estivesse completa. O chamador devolve ERR_ABRT ao lwIP.
+static err_t abort_http_conn(http_conn_t *conn)
+{
+    struct tcp_pcb *tpcb = conn->pcb;
+    conn->pcb = NULL;
+    if (!tpcb)
+        return ERR_OK;
+
+    tcp_arg(tpcb, NULL);
+    tcp_recv(tpcb, NULL);
+    tcp_err(tpcb, NULL);
+    tcp_poll(tpcb, NULL, 0);
+    tcp_abort(tpcb);
+    return ERR_ABRT;
+}
+
+// Escreve na conexão e registra a falha (ERR_MEM sem buffers do lwIP); depois de uma falha as
+// escritas seguintes da mesma resposta são descartadas
+static bool http_write(http_conn_t *conn, const void *data, uint16_t len, uint8_t flags)
+{
+    if (conn->write_failed)
+        return false;
+    if (tcp_write(conn->pcb, data, len, flags) != ERR_OK)
+        conn->write_failed = true;
+    return !conn->write_failed;
+}
+
+// Libera o slot de uma conexão que passou a ser controlada por SSE/WebSocket
+static void detach_http_conn(http_conn_t *conn)
+{
+    tcp_poll(conn->pcb, NULL, 0);
+    conn->pcb = NULL;
+}
+
+// Aplica uma transição na vaga e a registra no diário se ela ocorreu
+static bool apply_transition(int index, uint32_t from_mask, parking_status_t to, journal_source_t source, uint32_t now)
+{
+    parking_status_t previous;
+
+    if (!parking_transition(&parking, index, from_mask, to, now, &previous))
+        return false;
+
+    journal_append(&parking_journal, now, index, previous, to, source);
+
+    taskENTER_CRITICAL(); // O(1): histogramas, médias com decaimento e resumo da hora
+    analytics_record(&parking_analytics, index, to, now);
+    taskEXIT_CRITICAL();
+
+    mark_spot_dirty(index);
+    return true;
+}
+
+// Marca a vaga como alterada no conjunto de cada consumidor (antes da notificação)
+static void mark_spot_dirty(int index)
+{
+    for (int c = 0; c < OUTPUT_COUNT; c++)
+        atomic_fetch_or_explicit(&dirty_spots[c][index / 32], 1u << (index % 32), memory_order_release);
+}
+
+// Retira de uma vez as vagas pendentes do consumidor. Deve ser chamada antes de copiar o estado:
+// uma alteração posterior volta a marcar a vaga e é tratada na próxima notificação.
+static bool take_dirty_spots(output_consumer_t consumer, uint32_t *dirty)
+{
+    bool any = false;
+    for (int w = 0; w < PARKING_BITMAP_WORDS(PARKING_LOT_SIZE); w++)
+    {
+        dirty[w] = atomic_exchange_explicit(&dirty_spots[consumer][w], 0, memory_order_acquire);
+        any |= dirty[w] != 0;
+    }
+    return any;
+}
+
+// Retira e retorna a próxima vaga do conjunto obtido por take_dirty_spots, ou -1 se acabou
+static int next_dirty_spot(uint32_t *dirty)
+{
+    for (int w = 0; w < PARKING_BITMAP_WORDS(PARKING_LOT_SIZE); w++)
+    {
+        if (dirty[w])
+        {
+            int index = w * 32 + __builtin_ctz(dirty[w]);
+            dirty[w] &= dirty[w] - 1;
+            return index;
+        }
+    }
+    return -1;
+}
+
+// Aplica uma transição na vaga e notifica as tarefas de saída se ela ocorreu
+static bool change_parking_lot(int index, uint32_t from_mask, parking_status_t to, journal_source_t source)
+{
+    if (!apply_transition(index, from_mask, to, source, to_ms_since_boot(get_absolute_time())))
+        return false;
+
+    notify_output_tasks(); // Notifica as tarefas de saída
+    return true;
+}
+
+// Reserva uma vaga livre (usado pela rota HTTP e pelo WebSocket)
+bool reserve_parking_lot(int index, journal_source_t source)
+{
+    if (!change_parking_lot(index, PARKING_FROM(PARKING_FREE), PARKING_RESERVED, source))
+        return false;
+
+    // Agenda a expiração e acorda a tarefa de reservas para recalcular o próximo prazo
+    taskENTER_CRITICAL();
+    expiry_schedule(&reservation_expiry, index, parking_since_ms(&parking, index) + reservation_timeout_ms(index));
+    taskEXIT_CRITICAL();
+
+    if (xReservationTimeoutTaskHandle != NULL)
+        xTaskNotifyGive(xReservationTimeoutTaskHandle);
+    return true;
+}
+
+// Tempo de reserva da classe da vaga (comum ou PCD)
+static uint32_t reservation_timeout_ms(int index)
+{
+    return parking_is_pcd(&parking, index) ? RESERVATION_PCD_TIMEOUT_MS : RESERVATION_TIMEOUT_MS;
+}
+
+// Marca uma vaga livre ou reservada como ocupada
+bool occupy_parking_lot(int index, journal_source_t source)
+{
+    return change_parking_lot(index, PARKING_FROM(PARKING_FREE) | PARKING_FROM(PARKING_RESERVED), PARKING_OCCUPIED, source);
+}
+
+// Libera uma vaga
+bool release_parking_lot(int index, journal_source_t source)
+{
+    return change_parking_lot(index, PARKING_FROM_ANY, PARKING_FREE, source);
+}
+
+// Copia o estado das vagas de forma consistente. Se uma transição estiver em andamento, cede a CPU por
+// um tick para que o escritor (que pode ter prioridade menor que a tarefa leitora) termine.
+static void take_parking_snapshot(parking_snapshot_t *snapshot, uint32_t *words)
+{
+    snapshot->words = words;
+    while (!parking_snapshot_try(&parking, snapshot))
+        vTaskDelay(1);
+}
+
+// Acrescenta texto formatado ao cache a partir de pos, sem passar do fim. snprintf retorna o tamanho
+// que teria escrito; pos fica limitado a sizeof(json_cache), que marca o cache como cheio.
+static int json_cache_printf(int pos, const char *format, ...)
+{
+    if (pos >= (int)sizeof(json_cache))
+        return sizeof(json_cache);
+
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(json_cache + pos, sizeof(json_cache) - pos, format, args);
+    va_end(args);
+
+    // Um texto que só caberia sem o terminador também foi cortado
+    return (len < 0 || pos + len >= (int)sizeof(json_cache)) ? (int)sizeof(json_cache) : pos + len;
+}
+
+// Acrescenta um caractere ao cache, ou o marca como cheio
+static int json_cache_putc(int pos, char c)
+{
+    if (pos >= (int)sizeof(json_cache))
+        return sizeof(json_cache);
+    json_cache[pos] = c;
+    return pos + 1;
+}
+
+// Renderiza o estado das vagas no cache de resposta; a página em si é estática e vem do sistema de arquivos
+static void render_status_json()
+{
+    uint32_t version = atomic_load_explicit(&parking_state_version, memory_order_acquire); // Lida antes da renderização para não perder alterações concorrentes
+
+    uint32_t words[PARKING_STORE_WORDS(PARKING_LOT_SIZE)];
+    uint16_t zone_counts[PARKING_ZONES][PARKING_STATUS_COUNT];
+    uint16_t floor_counts[PARKING_FLOORS][PARKING_STATUS_COUNT];
+    parking_snapshot_t snapshot = {.zone_counts = zone_counts, .floor_counts = floor_counts};
+    take_parking_snapshot(&snapshot, words);
+
+    // JSON compacto: {"v":"boot-versão","s":[status...],"pcd":[0|1...],
+    //                 "zones":[{"n":nome,"f":andar,"c":[livres,ocupadas,reservadas]}...],"floors":[[...]...]}
+    int pos = json_cache_printf(0, "{\"v\":\"%08lx-%lu\",\"s\":[", (unsigned long)boot_id, (unsigned long)version);
+    for (int i = 0; i < PARKING_LOT_SIZE; i++)
+    {
+        pos = json_cache_putc(pos, '0' + parking_snapshot_status(&snapshot, i));
+        pos = json_cache_putc(pos, (i < PARKING_LOT_SIZE - 1) ? ',' : ']');
+    }
+    pos = json_cache_printf(pos, ",\"pcd\":[");
+    for (int i = 0; i < PARKING_LOT_SIZE; i++)
+    {
+        pos = json_cache_putc(pos, parking_snapshot_is_pcd(&snapshot, i) ? '1' : '0');
+        pos = json_cache_putc(pos, (i < PARKING_LOT_SIZE - 1) ? ',' : ']');
+    }
+    pos = json_cache_printf(pos, ",\"zones\":[");
+    for (size_t z = 0; z < PARKING_ZONES; z++)
+    {
+        pos = json_cache_printf(pos, "{\"n\":\"%s\",\"f\":%u,\"c\":[%u,%u,%u]}%c",
+                                parking_zones[z].name, parking_zones[z].floor,
+                                zone_counts[z][PARKING_FREE], zone_counts[z][PARKING_OCCUPIED], zone_counts[z][PARKING_RESERVED],
+                                (z < PARKING_ZONES - 1) ? ',' : ']');
+    }
+    pos = json_cache_printf(pos, ",\"floors\":[");
+    for (int f = 0; f < PARKING_FLOORS; f++)
+    {
+        pos = json_cache_printf(pos, "[%u,%u,%u]%c",
+                                floor_counts[f][PARKING_FREE], floor_counts[f][PARKING_OCCUPIED], floor_counts[f][PARKING_RESERVED],
+                                (f < PARKING_FLOORS - 1) ? ',' : ']');
+    }
+    pos = json_cache_putc(pos, '}');
+
+    // Cheio: as zonas configuradas (nomes longos, muitas zonas ou andares) não cabem no tamanho de
+    // json_cache. É um erro de configuração; servir o JSON cortado deixaria a página quebrada.
+    if (pos >= (int)sizeof(json_cache))
+        panic("json_cache pequeno demais para o estado das vagas");
+    json_cache_len = pos;
+
+    json_cache_version = version;
+    json_cache_valid = true;
+}
+
+// Função de callback para processar requisições HTTP
+static err_t tcp_server_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err)
+{
+    http_conn_t *conn = (http_conn_t *)arg;
+
+    if (!p)
+    {
+        if (conn && conn->pcb == tpcb)
+            return close_http_conn(conn);
+        tcp_recv(tpcb, NULL);
+        tcp_close(tpcb);
+        return ERR_OK;
+    }
+
+    tcp_recved(tpcb, p->tot_len);
+    if (conn)
+        conn->last_active_ms = to_ms_since_boot(get_absolute_time());
+
+    err_t result = ERR_OK;
+
+    // Percorre a cadeia de pbufs sem copiar; uma requisição pode vir dividida em vários segmentos
+    for (struct pbuf *q = p; q != NULL && conn != NULL && conn->pcb == tpcb; q = q->next)
+    {
+        const char *data = (const char *)q->payload;
+        size_t len = q->len;
+
+        while (len > 0 && conn->pcb == tpcb)
+        {
+            size_t used = http_parser_feed(&conn->parser, data, len);
+            data += used;
+            len -= used;
+
+            if (conn->parser.state == HTTP_STATE_DONE)
+            {
+                result = handle_http_request(conn);
+                http_parser_init(&conn->parser);
+            }
+            else if (conn->parser.state == HTTP_STATE_ERROR)
+            {
+                if (!http_write(conn, http_bad_request, sizeof(http_bad_request) - 1, 0))
+                {
+                    result = abort_http_conn(conn);
+                    break;
+                }
+                tcp_output(tpcb);
+                result = close_http_conn(conn);
+            }
+        }
+    }
+
+    // libera um buffer de pacote (pbuf) que foi alocado anteriormente
+    pbuf_free(p);
+
+    return result;
+}
+
+// Responde uma requisição cujos cabeçalhos já foram analisados
+static err_t handle_http_request(http_conn_t *conn)
+{
+    struct tcp_pcb *tpcb = conn->pcb;
+    const http_parser_t *request = &conn->parser;
+
+    // printf("Request: %s\n", request->path);
+
+    // HTTP/1.1 mantém a conexão por padrão; HTTP/1.0 apenas com "Connection: keep-alive"
+    conn->keep_alive = (request->version_minor >= 1) ? !request->connection_close : request->connection_keep_alive;
+
+    int id;
+    conn->write_failed = false;
+    const http_route_t *route = http_route_match(http_routes, sizeof(http_routes) / sizeof(http_routes[0]),
+                                                 request->method, request->path, &id);
+    if (route)
+        route->handler(conn, id);
+    else if (request->method != HTTP_METHOD_GET || !send_static_file(conn, request->path))
+        http_write(conn, http_not_found, sizeof(http_not_found) - 1, 0);
+
+    if (conn->pcb == tpcb && conn->write_failed)
+        return abort_http_conn(conn);
+    tcp_output(tpcb);
+
+    // Conexões promovidas a SSE/WebSocket já não pertencem ao slot HTTP
+    if (conn->pcb == tpcb && !conn->keep_alive)
+        return close_http_conn(conn);
+    return ERR_OK;
+}
+
+// Renderiza o cache de respostas apenas se o estado das vagas mudou desde a última renderização
+static void refresh_response_cache()
+{
+    if (!json_cache_valid || json_cache_version != atomic_load_explicit(&parking_state_version, memory_order_acquire))
+        render_status_json();
+}
+
+// Envia um arquivo do sistema de arquivos do httpd. Os arquivos já trazem o cabeçalho HTTP e o corpo
+// comprimido com gzip, então são enviados direto da flash sem cópia; responde 304 se o ETag coincidir
+// e 406 se o Accept-Encoding do cliente não aceita gzip (não há cópia sem compressão).
+static bool send_static_file(http_conn_t *conn, const char *path)
+{
+    // Ignora a query string (?v=hash usada para versionar os assets)
+    char name[HTTP_PATH_MAX + 1];
+    size_t n = 0;
+    while (path[n] && path[n] != '?' && n < sizeof(name) - 1)
+    {
+        name[n] = path[n];
+        n++;
+    }
+    name[n] = '\0';
+
+    struct fs_file file;
+    if (fs_open(&file, name) != ERR_OK)
+        return false;
+
+    if (conn->parser.gzip_refused)
+    {
+        http_write(conn, http_not_acceptable, sizeof(http_not_acceptable) - 1, 0);
+        fs_close(&file);
+        return true;
+    }
+
+    // O ETag está no cabeçalho embutido; só é procurado se o cliente enviou If-None-Match
+    if (conn->parser.etag[0] != '\0')
+    {
+        static const char etag_field[] = "\r\nETag: ";
+        const int field_len = sizeof(etag_field) - 1;
+        const int etag_len = strlen(conn->parser.etag);
+
+        for (int i = 0; i + 4 <= file.len && memcmp(file.data + i, "\r\n\r\n", 4) != 0; i++)
+        {
+            if (i + field_len + etag_len < file.len && memcmp(file.data + i, etag_field, field_len) == 0)
+            {
+                if (memcmp(file.data + i + field_len, conn->parser.etag, etag_len) == 0 &&
+                    file.data[i + field_len + etag_len] == '\r')
+                {
+                    char header[128];
+                    int len = snprintf(header, sizeof(header), http_not_modified, conn->parser.etag,
+                                       conn->keep_alive ? "keep-alive" : "close");
+                    http_write(conn, header, len, TCP_WRITE_FLAG_COPY);
+                    fs_close(&file);
+                    return true;
+                }
+                break;
+            }
+        }
+    }
+
+    http_write(conn, file.data, file.len, 0);
+    fs_close(&file);
+    return true;
+}
+
+// Executa uma ação sobre a vaga N (1..PARKING_LOT_SIZE) e redireciona para a página, ou 404 se a vaga não existe
+static void route_spot_action(http_conn_t *conn, int id, bool (*action)(int index, journal_source_t source))
+{
+    if (id < 1 || id > PARKING_LOT_SIZE)
+    {
+        http_write(conn, http_not_found, sizeof(http_not_found) - 1, 0);
+        return;
+    }
+
+    action(id - 1, JOURNAL_SOURCE_HTTP);
+    http_write(conn, http_see_other, sizeof(http_see_other) - 1, 0);
+}
+
+// GET /
+static void route_page(void *ctx, int id)
+{
+    http_conn_t *conn = (http_conn_t *)ctx;
+    if (!send_static_file(conn, "/index.html"))
+        http_write(conn, http_not_found, sizeof(http_not_found) - 1, 0);
+}
+
+// GET /reservar-vaga-N
+static void route_reserve(void *ctx, int id)
+{
+    route_spot_action((http_conn_t *)ctx, id, reserve_parking_lot);
+}
+
+// GET /ocupar-vaga-N
+static void route_occupy(void *ctx, int id)
+{
+    route_spot_action((http_conn_t *)ctx, id, occupy_parking_lot);
+}
+
+// GET /liberar-vaga-N
+static void route_release(void *ctx, int id)
+{
+    route_spot_action((http_conn_t *)ctx, id, release_parking_lot);
+}
+
+// GET /admin/liberar-todas: libera todas as vagas de uma vez
+static void route_release_all(void *ctx, int id)
+{
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    bool changed = false;
+
+    for (int i = 0; i < PARKING_LOT_SIZE; i++)
+        changed |= apply_transition(i, PARKING_FROM_ANY, PARKING_FREE, JOURNAL_SOURCE_ADMIN, now);
+
+    if (changed)
+        notify_output_tasks(); // Notifica as tarefas de saída
+    http_write((http_conn_t *)ctx, http_see_other, sizeof(http_see_other) - 1, 0);
+}
+
+// GET /api/status
+static void route_api_status(void *ctx, int id)
+{
+    send_api_status((http_conn_t *)ctx);
+}
+
+// GET /events: a conexão passa a ser controlada pelo slot SSE
+static void route_events(void *ctx, int id)
+{
+    http_conn_t *conn = (http_conn_t *)ctx;
+    if (open_sse_stream(conn))
+        detach_http_conn(conn);
+}
+
+// GET /ws: a conexão passa a ser controlada pelo slot WebSocket
+static void route_websocket(void *ctx, int id)
+{
+    http_conn_t *conn = (http_conn_t *)ctx;
+    if (open_websocket(conn))
+        detach_http_conn(conn);
+}
+
+// GET /api/next-free?pcd=0|1: próxima vaga livre da classe e quantas restam, direto do índice de disponibilidade
+static void route_next_free(void *ctx, int id)
+{
+    http_conn_t *conn = (http_conn_t *)ctx;
+    const char *query = strchr(conn->parser.path, '?');
+    parking_class_t cls = (query && strstr(query, "pcd=1")) ? PARKING_CLASS_PCD : PARKING_CLASS_REGULAR;
+
+    int spot = parking_find_free(&parking, cls);
+    char body[48];
+    int body_len = (spot < 0)
+                       ? snprintf(body, sizeof(body), "{\"pcd\":%d,\"id\":null,\"free\":0}", cls)
+                       : snprintf(body, sizeof(body), "{\"pcd\":%d,\"id\":%d,\"free\":%u}", cls, spot + 1,
+                                  parking_count(&parking, cls, PARKING_FREE));
+
+    char header[160];
+    int len = snprintf(header, sizeof(header), api_json_header, body_len, conn->keep_alive ? "keep-alive" : "close");
+    if (http_write(conn, header, len, TCP_WRITE_FLAG_COPY | TCP_WRITE_FLAG_MORE))
+        http_write(conn, body, body_len, TCP_WRITE_FLAG_COPY);
+}
+
+// GET /api/events?since=seq: transições registradas a partir da sequência, em JSON com transferência
+// chunked. Os registros são lidos sem bloquear quem escreve no diário; os já sobrescritos são pulados.
+// O corpo é limitado ao espaço livre no buffer de envio e a HTTP_CHUNKED_BODY_MAX: o cliente continua
+// a partir de "next", que fica no fim do JSON.
+static void route_journal(void *ctx, int id)
+{
+    http_conn_t *conn = (http_conn_t *)ctx;
+    const char *query = strchr(conn->parser.path, '?');
+    const char *param = query ? strstr(query, "since=") : NULL;
+    uint32_t since = param ? strtoul(param + 6, NULL, 10) : 0;
+
+    // As sequências só crescem (com volta em 2^32), então a comparação é pela diferença. Uma sequência
+    // à frente do diário (cliente de antes de um reboot, que recomeça em 0) recebe a lista vazia e o
+    // "next" atual.
+    uint32_t head = journal_head(&parking_journal);
+    uint32_t oldest = journal_oldest(&parking_journal);
+    if ((int32_t)(since - oldest) < 0)
+        since = oldest;
+    else if ((int32_t)(since - head) > 0)
+        since = head;
+
+    char header[160];
+    int len = snprintf(header, sizeof(header), api_chunked_header, conn->keep_alive ? "keep-alive" : "close");
+    if (!http_write(conn, header, len, TCP_WRITE_FLAG_COPY | TCP_WRITE_FLAG_MORE))
+        return;
+
+    int budget = tcp_sndbuf(conn->pcb);
+    if (budget > HTTP_CHUNKED_BODY_MAX)
+        budget = HTTP_CHUNKED_BODY_MAX;
+    const int reserve = 48; // Fechamento com "next", cabeçalho e fim do último chunk e o chunk final
+    int sent = 0;           // Bytes já entregues ao lwIP, com o enquadramento dos chunks
+
+    // Cada chunk leva vários registros: "<tamanho hex>\r\n<dados>\r\n"
+    char chunk[384];
+    const int prefix = 5; // Espaço reservado para "XXX\r\n"
+    int pos = prefix;
+    pos += snprintf(chunk + pos, sizeof(chunk) - pos, "{\"oldest\":%lu,\"events\":[", (unsigned long)oldest);
+
+    bool first = true;
+    uint32_t seq;
+    for (seq = since; seq != head; seq++)
+    {
+        journal_record_t record;
+        if (journal_read(&parking_journal, seq, &record) != JOURNAL_OK)
+            continue;
+
+        char item[96];
+        int item_len = snprintf(item, sizeof(item), "%s{\"seq\":%lu,\"t\":%lu,\"id\":%u,\"from\":%u,\"to\":%u,\"src\":%u}",
+                                first ? "" : ",", (unsigned long)record.seq, (unsigned long)record.timestamp_ms,
+                                record.spot + 1, record.old_status, record.new_status, record.source);
+        if (sent + (pos - prefix) + item_len + reserve > budget)
+            break; // Este registro e os seguintes ficam para a próxima requisição
+        first = false;
+
+        if (pos + item_len > (int)sizeof(chunk) - 32) // Mantém espaço para o fechamento e o "\r\n" final
+        {
+            if (!send_chunk(conn, chunk, prefix, pos - prefix))
+                return;
+            sent += pos - prefix + 7;
+            pos = prefix;
+        }
+        memcpy(chunk + pos, item, item_len);
+        pos += item_len;
+    }
+
+    pos += snprintf(chunk + pos, sizeof(chunk) - pos, "],\"next\":%lu}", (unsigned long)seq);
+    if (send_chunk(conn, chunk, prefix, pos - prefix))
+        http_write(conn, "0\r\n\r\n", 5, 0); // Último chunk
+}
+
+// GET /api/stats: estatísticas de uso em JSON com transferência chunked. Utilização e no-show em partes
+// por mil, permanência média em segundos. Cada hora é [idade, chegadas, saídas, reservas, no-shows,
+// ocupação média por mil, pico de vagas ocupadas], da hora corrente (idade 0) para trás.
+static void route_stats(void *ctx, int id)
+{
+    http_conn_t *conn = (http_conn_t *)ctx;
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+
+    char header[160];
+    int len = snprintf(header, sizeof(header), api_chunked_header, conn->keep_alive ? "keep-alive" : "close");
+    if (!http_write(conn, header, len, TCP_WRITE_FLAG_COPY | TCP_WRITE_FLAG_MORE))
+        return; // Sem buffers no lwIP: handle_http_request aborta a conexão
+
+    char chunk[384];
+    const int prefix = 5; // Espaço reservado para "XXX\r\n"
+    int pos = prefix;
+    pos += snprintf(chunk + pos, sizeof(chunk) - pos, "{\"t\":%lu,\"zones\":[", (unsigned long)(now / 1000));
+
+    // Cada item é lido numa seção crítica curta e formatado fora dela
+    char item[160];
+    for (size_t z = 0; z < PARKING_ZONES; z++)
+    {
+        uint16_t hist[ANALYTICS_DWELL_BUCKETS];
+        taskENTER_CRITICAL();
+        uint16_t utilization = analytics_zone_utilization(&parking_analytics, z, now);
+        uint32_t mean = analytics_zone_mean_dwell_s(&parking_analytics, z);
+        uint16_t no_show = analytics_zone_no_show(&parking_analytics, z);
+        uint32_t reservations = analytics_zones[z].reservations;
+        memcpy(hist, analytics_zones[z].dwell_hist, sizeof(hist));
+        taskEXIT_CRITICAL();
+
+        int item_len = snprintf(item, sizeof(item), "%s{\"n\":\"%s\",\"u\":%u,\"m\":%lu,\"ns\":%u,\"r\":%lu,\"h\":[",
+                                z ? "," : "", parking_zones[z].name, utilization, (unsigned long)mean, no_show,
+                                (unsigned long)reservations);
+        for (int b = 0; b < ANALYTICS_DWELL_BUCKETS; b++)
+            item_len += snprintf(item + item_len, sizeof(item) - item_len, "%u%s", hist[b],
+                                 (b < ANALYTICS_DWELL_BUCKETS - 1) ? "," : "]}");
+
+        if (pos + item_len > (int)sizeof(chunk) - 16) // Mantém espaço para o fechamento e o "\r\n" final
+        {
+            if (!send_chunk(conn, chunk, prefix, pos - prefix))
+                return;
+            pos = prefix;
+        }
+        memcpy(chunk + pos, item, item_len);
+        pos += item_len;
+    }
+
+    pos += snprintf(chunk + pos, sizeof(chunk) - pos, "],\"spots\":[");
+    for (int i = 0; i < PARKING_LOT_SIZE; i++)
+    {
+        taskENTER_CRITICAL();
+        uint16_t utilization = analytics_spot_utilization(&parking_analytics, i, now);
+        uint32_t mean = analytics_spot_mean_dwell_s(&parking_analytics, i);
+        taskEXIT_CRITICAL();
+
+        int item_len = snprintf(item, sizeof(item), "%s[%u,%lu]", i ? "," : "", utilization, (unsigned long)mean);
+        if (pos + item_len > (int)sizeof(chunk) - 16)
+        {
+            if (!send_chunk(conn, chunk, prefix, pos - prefix))
+                return;
+            pos = prefix;
+        }
+        memcpy(chunk + pos, item, item_len);
+        pos += item_len;
+    }
+
+    pos += snprintf(chunk + pos, sizeof(chunk) - pos, "],\"hours\":[");
+    taskENTER_CRITICAL();
+    analytics_advance(&parking_analytics, now); // Fecha as horas sem eventos até agora
+    taskEXIT_CRITICAL();
+    bool first = true;
+    for (int age = 0; age < ANALYTICS_HOURS; age++)
+    {
+        analytics_hour_t hour;
+        taskENTER_CRITICAL();
+        const analytics_hour_t *slot = analytics_hour_at(&parking_analytics, age);
+        if (slot)
+            hour = *slot;
+        taskEXIT_CRITICAL();
+        if (!slot)
+            break;
+
+        // A hora corrente só conta o tempo já decorrido (a primeira hora começa no boot)
+        uint32_t span = age ? 3600000 : now - hour.hour * 3600000;
+        uint32_t occupancy = span ? (uint32_t)((hour.occupied_spot_ms * 1000) / ((uint64_t)span * PARKING_LOT_SIZE)) : 0;
+
+        int item_len = snprintf(item, sizeof(item), "%s[%d,%u,%u,%u,%u,%lu,%u]", first ? "" : ",", age,
+                                hour.arrivals, hour.departures, hour.reservations, hour.no_shows,
+                                (unsigned long)occupancy, hour.peak_occupied);
+        first = false;
+        if (pos + item_len > (int)sizeof(chunk) - 16)
+        {
+            if (!send_chunk(conn, chunk, prefix, pos - prefix))
+                return;
+            pos = prefix;
+        }
+        memcpy(chunk + pos, item, item_len);
+        pos += item_len;
+    }
+
+    pos += snprintf(chunk + pos, sizeof(chunk) - pos, "]}");
+    if (send_chunk(conn, chunk, prefix, pos - prefix))
+        http_write(conn, "0\r\n\r\n", 5, 0); // Último chunk
+}
+
+// Envia um chunk montado em buffer + prefix; os bytes reservados antes dos dados recebem o tamanho em hex
+static bool send_chunk(http_conn_t *conn, char *buffer, int prefix, int len)
+{
+    char size[8];
+    int size_len = snprintf(size, sizeof(size), "%x\r\n", len);
+    char *start = buffer + prefix - size_len;
+    memcpy(start, size, size_len);
+    memcpy(buffer + prefix + len, "\r\n", 2);
+    return http_write(conn, start, size_len + len + 2, TCP_WRITE_FLAG_COPY | TCP_WRITE_FLAG_MORE);
+}
+
+// Responde GET /api/status com o JSON em cache, ou 304 se o cliente já possui a versão atual
+static void send_api_status(http_conn_t *conn)
+{
+    refresh_response_cache();
+
+    char etag[24];
+    snprintf(etag, sizeof(etag), "\"%08lx-%lu\"", (unsigned long)boot_id, (unsigned long)json_cache_version);
+
+    const char *connection = conn->keep_alive ? "keep-alive" : "close";
+    char header[192];
+    int len;
+    if (strcmp(conn->parser.etag, etag) == 0)
+    {
+        len = snprintf(header, sizeof(header), http_not_modified, etag, connection);
+        http_write(conn, header, len, TCP_WRITE_FLAG_COPY);
+        return;
+    }
+
+    len = snprintf(header, sizeof(header), api_status_header, etag, json_cache_len, connection);
+    if (http_write(conn, header, len, TCP_WRITE_FLAG_COPY | TCP_WRITE_FLAG_MORE))
+        http_write(conn, json_cache, json_cache_len, TCP_WRITE_FLAG_COPY);
+}
+
+// Registra a conexão como cliente SSE, ou responde 503 se não houver espaço. O primeiro evento é o
+// estado completo, como no WebSocket: a página não depende de /api/status, que poderia chegar depois
+// dos eventos e sobrescrevê-los. A conexão só passa para o slot SSE se tudo foi aceito; senão
+// handle_http_request a aborta.
+static bool open_sse_stream(http_conn_t *conn)
+{
+    struct tcp_pcb *tpcb = conn->pcb;
+    for (int i = 0; i < MAX_SSE_CLIENTS; i++)
+    {
+        if (sse_clients[i] == NULL)
+        {
+            refresh_response_cache();
+            if (!http_write(conn, sse_header, sizeof(sse_header) - 1, TCP_WRITE_FLAG_MORE) ||
+                !http_write(conn, "data: ", 6, TCP_WRITE_FLAG_MORE) ||
+                !http_write(conn, json_cache, json_cache_len, TCP_WRITE_FLAG_COPY | TCP_WRITE_FLAG_MORE) ||
+                !http_write(conn, "\n\n", 2, 0))
+                return false;
+            sse_clients[i] = tpcb;
+            tcp_arg(tpcb, &sse_clients[i]);
+            tcp_recv(tpcb, tcp_sse_recv);
+            tcp_err(tpcb, tcp_sse_err);
+            tcp_poll(tpcb, tcp_sse_poll, SSE_KEEPALIVE_INTERVAL);
+            return true;
+        }
+    }
+
+    http_write(conn, sse_unavailable, sizeof(sse_unavailable) - 1, 0);
+    return false;
+}
+
+// Callback de recepção das conexões SSE: o cliente não envia dados, apenas encerra
+static err_t tcp_sse_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err)
+{
+    if (!p)
+    {
+        remove_sse_client(tpcb);
+        tcp_recv(tpcb, NULL);
+        tcp_close(tpcb);
+        return ERR_OK;
     }
 
-    // GPIO do CI CYW43 em nível baixo
-    cyw43_arch_gpio_put(CYW43_LED_PIN, 0);
+    tcp_recved(tpcb, p->tot_len);
+    pbuf_free(p);
+    return ERR_OK;
+}
 
-    // Ativa o Wi-Fi no modo Station, de modo a que possam ser feitas ligações a outros pontos de acesso Wi-Fi.
-    cyw43_arch_enable_sta_mode();
+// Comentário SSE periódico. Um cliente que sumiu sem FIN (Wi-Fi caiu, celular dormiu) não confirma
+// nada e o lwIP começa a retransmitir: depois de SSE_MAX_RETRANSMITS, ou se não há espaço para o
+// comentário, o slot é liberado e a conexão abortada; um cliente ainda vivo reconecta pelo EventSource.
+static err_t tcp_sse_poll(void *arg, struct tcp_pcb *tpcb)
+{
+    static const char keepalive[] = ":\n\n";
 
-    // Conectar à rede WiFI - fazer um loop até que esteja conectado
-    // printf("Conectando ao Wi-Fi...\n");
-    while (cyw43_arch_wifi_connect_timeout_ms(WIFI_SSID, WIFI_PASSWORD, CYW43_AUTH_WPA2_AES_PSK, 20000))
+    if (tpcb->nrtx >= SSE_MAX_RETRANSMITS || tcp_write(tpcb, keepalive, sizeof(keepalive) - 1, 0) != ERR_OK)
     {
-        // printf("Falha ao conectar ao Wi-Fi\n");
-        sleep_ms(100);
-        return -1;
+        remove_sse_client(tpcb);
+        tcp_recv(tpcb, NULL);
+        tcp_abort(tpcb);
+        return ERR_ABRT;
     }
-    // printf("Conectado ao Wi-Fi\n");
+    tcp_output(tpcb);
+    return ERR_OK;
+}
 
-    // Caso seja a interface de rede padrão - imprimir o IP do dispositivo.
-    if (netif_default)
+// Remove a conexão da lista de clientes SSE, se estiver registrada
+static void remove_sse_client(struct tcp_pcb *tpcb)
+{
+    for (int i = 0; i < MAX_SSE_CLIENTS; i++)
     {
-        printf("IP do dispositivo: %s\n", ipaddr_ntoa(&netif_default->ip_addr));
+        if (sse_clients[i] == tpcb)
+        {
+            sse_clients[i] = NULL;
+            tcp_arg(tpcb, NULL);
+            tcp_err(tpcb, NULL);
+            tcp_poll(tpcb, NULL, 0);
+        }
     }
+}
 
-    return 0;
+// Callback de erro das conexões SSE: o PCB já foi liberado pelo lwIP
+static void tcp_sse_err(void *arg, err_t err)
+{
+    struct tcp_pcb **slot = (struct tcp_pcb **)arg;
+    if (slot)
+        *slot = NULL;
 }
 
-// Inicializa o servidor web
-int init_webserver(struct tcp_pcb **server)
+// Faz o upgrade da conexão para WebSocket (RFC 6455) e envia o estado atual. A conexão só passa
+// para o slot WebSocket se a resposta foi aceita; senão handle_http_request a aborta.
+static bool open_websocket(http_conn_t *conn)
 {
-    // vincula um PCB TCP a um endereço IP e porta específicos
-    if (tcp_bind(*server, IP_ADDR_ANY, 80) != ERR_OK)
+    struct tcp_pcb *tpcb = conn->pcb;
+    const http_parser_t *request = &conn->parser;
+    if (!request->upgrade_websocket || strlen(request->ws_key) != WS_KEY_LEN)
     {
-        // printf("Falha ao associar servidor TCP à porta 80\n");
-        return -1;
+        http_write(conn, http_bad_request, sizeof(http_bad_request) - 1, 0);
+        return false;
     }
 
-    // Coloca o PCB TCP em modo de escuta
-    *server = tcp_listen(*server); // Atualiza o ponteiro original
-    if (*server == NULL)
+    ws_client_t *client = NULL;
+    for (int i = 0; i < MAX_WS_CLIENTS; i++)
     {
-        // printf("Falha ao criar servidor de escuta\n");
-        return -1;
+        if (ws_clients[i].pcb == NULL)
+        {
+            client = &ws_clients[i];
+            break;
+        }
     }
 
-    // Define função de callback para aceitar conexões
-    tcp_accept(*server, tcp_server_accept);
-    // printf("Servidor ouvindo na porta 80\n");
+    if (!client)
+    {
+        http_write(conn, sse_unavailable, sizeof(sse_unavailable) - 1, 0);
+        return false;
+    }
 
-    return 0;
+    char accept[WS_ACCEPT_LEN + 1];
+    char header[160];
+    ws_accept_key(request->ws_key, accept);
+    refresh_response_cache();
+    int len = snprintf(header, sizeof(header), ws_upgrade_header, accept);
+
+    if (!http_write(conn, header, len, TCP_WRITE_FLAG_COPY | TCP_WRITE_FLAG_MORE))
+        return false;
+    if (ws_send(tpcb, WS_OPCODE_TEXT, json_cache, json_cache_len) != ERR_OK) // Estado completo no mesmo formato de /api/status
+    {
+        conn->write_failed = true;
+        return false;
+    }
+
+    client->pcb = tpcb;
+    client->rx_len = 0;
+    tcp_arg(tpcb, client);
+    tcp_recv(tpcb, tcp_ws_recv);
+    tcp_err(tpcb, tcp_ws_err);
+    return true;
 }
 
-// Inicializa o estacionamento
-void init_parking_lots()
+// Libera o slot de uma conexão WebSocket
+static void remove_ws_client(ws_client_t *client)
 {
-    for (int i = 0; i < PARKING_LOT_SIZE; i++)
+    if (client->pcb)
     {
-        parking_lots[i].id = i + 1;                 // ID do estacionamento
-        parking_lots[i].status = 0;                 // Status do estacionamento (0 - livre)
-        parking_lots[i].reservation_start_time = 0; // Hora de início da reserva
-        parking_lots[i].is_pcd = false;             // Se o estacionamento é PCD (Pessoa com Deficiência)
+        tcp_arg(client->pcb, NULL);
+        tcp_recv(client->pcb, NULL);
+        tcp_err(client->pcb, NULL);
     }
-    parking_lots[PARKING_LOT_SIZE - 1].is_pcd = true; // o estacionamento 3 é PCD
+    client->pcb = NULL;
+    client->rx_len = 0;
 }
 
-// Função de callback ao aceitar conexões TCP
-static err_t tcp_server_accept(void *arg, struct tcp_pcb *newpcb, err_t err)
+// Callback de erro das conexões WebSocket: o PCB já foi liberado pelo lwIP
+static void tcp_ws_err(void *arg, err_t err)
 {
-    // printf("Conexão aceita\n");
-    tcp_recv(newpcb, tcp_server_recv);
-    return ERR_OK;
+    ws_client_t *client = (ws_client_t *)arg;
+    if (client)
+    {
+        client->pcb = NULL;
+        client->rx_len = 0;
+    }
 }
 
-// Tratamento do request do usuário - digite aqui
-void user_request(char **request)
+// Envia um quadro WebSocket (cabeçalho + payload)
+static err_t ws_send(struct tcp_pcb *tpcb, uint8_t opcode, const void *payload, size_t len)
 {
-    for (int i = 0; i < PARKING_LOT_SIZE; i++)
-    {
-        char endpoint[25];
-        snprintf(endpoint, sizeof(endpoint), "GET /reservar-vaga-%d", i + 1);
+    uint8_t header[WS_MAX_HEADER_LEN];
+    size_t header_len = ws_frame_header(header, opcode, len);
 
-        if (strstr(*request, endpoint) != NULL)
-        {
-            absolute_time_t current_time = pdTICKS_TO_MS(xTaskGetTickCount());
+    err_t err = tcp_write(tpcb, header, header_len, TCP_WRITE_FLAG_COPY | TCP_WRITE_FLAG_MORE);
+    if (err == ERR_OK && len > 0)
+        err = tcp_write(tpcb, payload, len, TCP_WRITE_FLAG_COPY);
+    return err;
+}
 
-            parking_lots[i].status = 2;                            // Vaga reservada
-            parking_lots[i].reservation_start_time = current_time; // Hora de início da reserva
+// Trata uma mensagem de texto do cliente: "reservar:N"
+static void ws_handle_message(const uint8_t *payload, size_t len)
+{
+    if (len > 9 && memcmp(payload, "reservar:", 9) == 0)
+    {
+        int id = 0;
+        for (size_t i = 9; i < len && payload[i] >= '0' && payload[i] <= '9'; i++)
+            id = id * 10 + (payload[i] - '0');
 
-            notify_output_tasks(); // Notifica as tarefas de saída
-            break;                 // Sai do loop após encontrar a vaga correspondente
-        }
+        if (id >= 1 && id <= PARKING_LOT_SIZE)
+            reserve_parking_lot(id - 1, JOURNAL_SOURCE_WEBSOCKET);
     }
 }
 
-// Função de callback para processar requisições HTTP
-static err_t tcp_server_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err)
+// Callback de recepção das conexões WebSocket
+static err_t tcp_ws_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err)
 {
+    ws_client_t *client = (ws_client_t *)arg;
+
     if (!p)
     {
+        if (client)
+            remove_ws_client(client);
         tcp_close(tpcb);
-        tcp_recv(tpcb, NULL);
         return ERR_OK;
     }
 
-    // Alocação do request na memória dinâmica
-    char *request = (char *)malloc(p->len + 1);
-    memcpy(request, p->payload, p->len);
-    request[p->len] = '\0';
-
-    // printf("Request: %s\n", request);
-
-    // Tratamento de request - Controle dos LEDs
-    user_request(&request);
-
-    char html[3000];
-
-    const char *status_class[] = {"disponivel", "ocupada", "reservada"};
-    const char *status_text[] = {"Disponível", "Ocupada", "Reservada"};
-    const char *disabled_btn[] = {"", "disabled", "disabled"};
-
-    snprintf(html, sizeof(html), html_data,
-             // Vaga 1
-             parking_lots[0].is_pcd ? "pcd" : "",
-             status_class[parking_lots[0].status],
-             parking_lots[0].is_pcd ? " - PCD" : "",
-             parking_lots[0].is_pcd ? "Vaga exclusiva para PCD" : "Vaga comum",
-             status_text[parking_lots[0].status],
-             disabled_btn[parking_lots[0].status],
-
-             // Vaga 2
-             parking_lots[1].is_pcd ? "pcd" : "",
-             status_class[parking_lots[1].status],
-             parking_lots[1].is_pcd ? " - PCD" : "",
-             parking_lots[1].is_pcd ? "Vaga exclusiva para PCD" : "Vaga comum",
-             status_text[parking_lots[1].status],
-             disabled_btn[parking_lots[1].status],
-
-             // Vaga 3
-             parking_lots[2].is_pcd ? "pcd" : "",
-             status_class[parking_lots[2].status],
-             parking_lots[2].is_pcd ? " - PCD" : "",
-             parking_lots[2].is_pcd ? "Vaga exclusiva para PCD" : "Vaga comum",
-             status_text[parking_lots[2].status],
-             disabled_btn[parking_lots[2].status],
-
-             // Vaga 4
-             parking_lots[3].is_pcd ? "pcd" : "",
-             status_class[parking_lots[3].status],
-             parking_lots[3].is_pcd ? " - PCD" : "",
-             parking_lots[3].is_pcd ? "Vaga exclusiva para PCD" : "Vaga comum",
-             status_text[parking_lots[3].status],
-             disabled_btn[parking_lots[3].status]);
-
-    tcp_write(tpcb, html, strlen(html), TCP_WRITE_FLAG_COPY);
-    tcp_output(tpcb);
+    if (!client)
+    {
+        tcp_recved(tpcb, p->tot_len);
+        pbuf_free(p);
+        tcp_abort(tpcb);
+        return ERR_ABRT;
+    }
 
-    // libera memória alocada dinamicamente
-    free(request);
+    // Os bytes entram no buffer da conexão em partes e cada quadro completo é tratado e retirado
+    // em seguida: um pbuf pode trazer vários quadros pequenos (Nagle ou envios agrupados)
+    ws_frame_t frame;
+    int used = 0;
+    bool closed = false;
+    for (uint16_t offset = 0; offset < p->tot_len && !closed && used >= 0;)
+    {
+        uint16_t n = p->tot_len - offset;
+        if (n > WS_RX_BUFFER_SIZE - client->rx_len)
+            n = WS_RX_BUFFER_SIZE - client->rx_len;
+        pbuf_copy_partial(p, client->rx + client->rx_len, n, offset);
+        client->rx_len += n;
+        offset += n;
+
+        while (!closed && (used = ws_parse_frame(client->rx, client->rx_len, WS_RX_BUFFER_SIZE, &frame)) > 0)
+        {
+            if (frame.opcode == WS_OPCODE_CLOSE)
+            {
+                ws_send(tpcb, WS_OPCODE_CLOSE, frame.payload, frame.len < 2 ? frame.len : 2);
+                closed = true;
+            }
+            else if (frame.opcode == WS_OPCODE_PING)
+            {
+                ws_send(tpcb, WS_OPCODE_PONG, frame.payload, frame.len);
+            }
+            else if (frame.opcode == WS_OPCODE_TEXT && frame.fin)
+            {
+                ws_handle_message(frame.payload, frame.len);
+            }
 
-    // libera um buffer de pacote (pbuf) que foi alocado anteriormente
+            client->rx_len -= used;
+            memmove(client->rx, client->rx + used, client->rx_len);
+        }
+    }
+    tcp_recved(tpcb, p->tot_len);
     pbuf_free(p);
 
+    // Um quadro sozinho maior que o buffer da conexão: fecha com 1009 (Message Too Big)
+    if (used == WS_PARSE_TOO_BIG)
+    {
+        static const uint8_t too_big[] = {0x03, 0xF1};
+        ws_send(tpcb, WS_OPCODE_CLOSE, too_big, sizeof(too_big));
+        closed = true;
+    }
+
+    if (closed)
+    {
+        remove_ws_client(client);
+        tcp_close(tpcb);
+        return ERR_OK;
+    }
+
+    // Quadro sem máscara: encerra a conexão
+    if (used < 0)
+    {
+        remove_ws_client(client);
+        tcp_abort(tpcb);
+        return ERR_ABRT;
+    }
+
+    tcp_output(tpcb);
     return ERR_OK;
 }
 
+// Envia um evento por vaga alterada desde o último envio a todos os clientes SSE e WebSocket
+static void push_state_events()
+{
+    char event[112];
+
+    uint32_t dirty[PARKING_BITMAP_WORDS(PARKING_LOT_SIZE)];
+    if (!take_dirty_spots(OUTPUT_WEB, dirty))
+        return;
+
+    uint32_t words[PARKING_STORE_WORDS(PARKING_LOT_SIZE)];
+    uint16_t zone_counts[PARKING_ZONES][PARKING_STATUS_COUNT];
+    parking_snapshot_t snapshot = {.zone_counts = zone_counts};
+    take_parking_snapshot(&snapshot, words);
+
+    cyw43_arch_lwip_begin(); // Chamadas ao lwIP fora do contexto de rede precisam do lock
+
+    // Percorre apenas as vagas alteradas desde o último envio
+    int i;
+    while ((i = next_dirty_spot(dirty)) >= 0)
+    {
+        uint8_t status = parking_snapshot_status(&snapshot, i);
+        int zone = parking_zone_of(&parking, i);
+
+        // "data: <json>\n\n" para SSE; o WebSocket envia apenas o <json>. Leva junto os contadores
+        // da zona da vaga, para a página atualizar o resumo sem percorrer as vagas.
+        int len = snprintf(event, sizeof(event), "data: {\"v\":\"%08lx-%lu\",\"id\":%d,\"s\":%d,\"z\":%d,\"zc\":[%u,%u,%u]}\n\n",
+                           (unsigned long)boot_id, (unsigned long)atomic_load_explicit(&parking_state_version, memory_order_relaxed), i + 1, status, zone,
+                           zone_counts[zone][PARKING_FREE], zone_counts[zone][PARKING_OCCUPIED], zone_counts[zone][PARKING_RESERVED]);
+
+        for (int c = 0; c < MAX_SSE_CLIENTS; c++)
+        {
+            struct tcp_pcb *client = sse_clients[c];
+            if (client == NULL)
+                continue;
+
+            // Cliente lento demais: encerra a conexão e deixa o EventSource reconectar
+            if (tcp_write(client, event, len, TCP_WRITE_FLAG_COPY) != ERR_OK)
+            {
+                remove_sse_client(client);
+                tcp_abort(client);
+                continue;
+            }
+            tcp_output(client);
+        }
+
+        for (int c = 0; c < MAX_WS_CLIENTS; c++)
+        {
+            struct tcp_pcb *client = ws_clients[c].pcb;
+            if (client == NULL)
+                continue;
+
+            if (ws_send(client, WS_OPCODE_TEXT, event + 6, len - 8) != ERR_OK)
+            {
+                remove_ws_client(&ws_clients[c]);
+                tcp_abort(client);
+                continue;
+            }
+            tcp_output(client);
+        }
+    }
+
+    cyw43_arch_lwip_end();
+}
+
 // Tarefa do servidor web
 void vWebServerTask(void *pvParameters)
 {
@@ -273,8 +1567,13 @@ void vWebServerTask(void *pvParameters)
         vTaskDelete(NULL);
     }
 
+    // Com NO_SYS=0 o lwIP roda na própria thread (tcpip); chamadas desta tarefa precisam do lock
+    cyw43_arch_lwip_begin();
     server = tcp_new(); // Cria um novo PCB TCP
-    if (!server || init_webserver(&server) != 0)
+    int result = server ? init_webserver(&server) : -1;
+    cyw43_arch_lwip_end();
+
+    if (result != 0)
     {
         // printf("Falha ao inicializar servidor web\n");
         vTaskDelete(NULL);
@@ -282,8 +1581,10 @@ void vWebServerTask(void *pvParameters)
 
     while (1)
     {
-        cyw43_arch_poll();              // Necessário para manter o Wi-Fi ativo
-        vTaskDelay(pdMS_TO_TICKS(100)); // Reduz a carga da CPU
+        // Os pacotes são tratados pela thread do lwIP assim que chegam; esta tarefa só acorda
+        // quando as vagas mudam, para repassar a alteração aos clientes SSE e WebSocket
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        push_state_events();
     }
 }
 
@@ -307,6 +1608,7 @@ void vInputControlTask(void *pvParameters)
 
             if (current_parking_lot > 0)
                 current_parking_lot--;
+            xTaskNotifyGive(xLedRGBTaskHandle); // O LED RGB mostra a zona da vaga selecionada
         }
         else if (btn_is_pressed(BTN_B_PIN) && (now - last_b) > debounce)
         {
@@ -314,21 +1616,15 @@ void vInputControlTask(void *pvParameters)
 
             if (current_parking_lot < PARKING_LOT_SIZE - 1)
                 current_parking_lot++;
+            xTaskNotifyGive(xLedRGBTaskHandle);
         }
         else if (btn_is_pressed(BTN_SW_PIN) && (now - last_sw) > debounce)
         {
             last_sw = now; // Atualiza o último tempo em que o botão do joystick foi pressionado
 
-            notify_output_tasks(); // Verifica se há notificações pendentes
-
-            if (parking_lots[current_parking_lot].status == 0 || parking_lots[current_parking_lot].status == 2)
-            {
-                parking_lots[current_parking_lot].status = 1; // Vaga ocupada
-            }
-            else if (parking_lots[current_parking_lot].status == 1)
-            {
-                parking_lots[current_parking_lot].status = 0; // Vaga livre
-            }
+            // Ocupa uma vaga livre ou reservada; se já estiver ocupada, libera
+            if (!occupy_parking_lot(current_parking_lot, JOURNAL_SOURCE_BUTTON))
+                release_parking_lot(current_parking_lot, JOURNAL_SOURCE_BUTTON);
         }
         vTaskDelay(pdMS_TO_TICKS(20));
     }
@@ -346,26 +1642,37 @@ void vLedMatrixTask(void *pvParameters)
 
     int color[3] = {0, 0, 0};
 
+    uint32_t dirty[PARKING_BITMAP_WORDS(PARKING_LOT_SIZE)];
+    uint32_t words[PARKING_STORE_WORDS(PARKING_LOT_SIZE)];
+    parking_snapshot_t snapshot = {0};
+
     ws2812b_init(LED_MATRIX_PIN);
 
+    // Desenha todas as vagas na primeira passagem; depois apenas as alteradas
+    take_dirty_spots(OUTPUT_LED_MATRIX, dirty);
+    for (int i = 0; i < PARKING_LOT_SIZE; i++)
+        dirty[i / 32] |= 1u << (i % 32);
+
     while (1)
     {
-        // Espera por uma notificação
-        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        take_parking_snapshot(&snapshot, words);
 
-        for (int i = 0; i < PARKING_LOT_SIZE; i++)
+        int i;
+        while ((i = next_dirty_spot(dirty)) >= 0)
         {
             color[0] = 0; // Vermelho
             color[1] = 0; // Verde
             color[2] = 0; // Azul
 
-            if (parking_lots[i].is_pcd && parking_lots[i].status == 0)
+            parking_status_t status = parking_snapshot_status(&snapshot, i);
+
+            if (parking_snapshot_is_pcd(&snapshot, i) && status == PARKING_FREE)
                 color[2] = 8; // Azul
-            else if (parking_lots[i].status == 0)
+            else if (status == PARKING_FREE)
                 color[1] = 8; // Verde
-            else if (parking_lots[i].status == 1)
+            else if (status == PARKING_OCCUPIED)
                 color[0] = 8; // Vermelho
-            else if (parking_lots[i].status == 2)
+            else if (status == PARKING_RESERVED)
             {
                 color[0] = 4; // Amarelo
                 color[1] = 8;
@@ -377,64 +1684,325 @@ void vLedMatrixTask(void *pvParameters)
 
         ws2812b_write();
         vTaskDelay(pdMS_TO_TICKS(100));
+
+        // Espera por uma notificação que traga vagas alteradas
+        do
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        while (!take_dirty_spots(OUTPUT_LED_MATRIX, dirty));
     }
 }
 
-// Tarefa de reserva
+// Tarefa de reserva: dorme até o prazo mais próximo e expira apenas as reservas vencidas
 void vReservationTimeoutTask(void *pvParameters)
 {
     while (1)
     {
-        TickType_t now = xTaskGetTickCount();
+        uint16_t index;
+        uint32_t deadline;
+        TickType_t wait = portMAX_DELAY;
 
-        for (int i = 0; i < PARKING_LOT_SIZE; i++)
+        taskENTER_CRITICAL();
+        bool scheduled = expiry_next(&reservation_expiry, &index, &deadline);
+        taskEXIT_CRITICAL();
+
+        if (scheduled)
         {
-            if (parking_lots[i].status == 2)
-            { // Se a vaga estiver reservada
-                if ((now - parking_lots[i].reservation_start_time) > pdMS_TO_TICKS(10000))
-                {
-                    parking_lots[i].status = 0; // Libera a vaga
+            int32_t remaining = (int32_t)(deadline - to_ms_since_boot(get_absolute_time()));
+            wait = (remaining > 0) ? pdMS_TO_TICKS(remaining) + 1 : 0;
+        }
+
+        // Uma nova reserva acorda a tarefa antes do prazo para recalcular a espera
+        if (wait > 0 && ulTaskNotifyTake(pdTRUE, wait))
+            continue;
 
-                    notify_output_tasks(); // Verifica se há notificações pendentes
-                    // printf("Reserva da vaga %d expirada\n", i + 1);
+        uint32_t now = to_ms_since_boot(get_absolute_time());
+        bool changed = false;
+
+        while (1)
+        {
+            taskENTER_CRITICAL();
+            bool due = expiry_pop_due(&reservation_expiry, now, &index);
+            taskEXIT_CRITICAL();
+            if (!due)
+                break;
+
+            // Só libera se a reserva que gerou o prazo ainda estiver ativa (a vaga pode ter sido
+            // ocupada, ou liberada e reservada de novo, nesse meio tempo)
+            uint32_t since = parking_since_ms(&parking, index);
+            uint32_t timeout = reservation_timeout_ms(index);
+            if ((int32_t)(now - since) >= (int32_t)timeout)
+            {
+                if (apply_transition(index, PARKING_FROM(PARKING_RESERVED), PARKING_FREE, JOURNAL_SOURCE_EXPIRY, now))
+                {
+                    changed = true;
+                    // printf("Reserva da vaga %d expirada\n", index + 1);
                 }
             }
+            else if (parking_get_status(&parking, index) == PARKING_RESERVED)
+            {
+                // Reserva mais nova que o prazo retirado: volta ao heap com o prazo dela, senão
+                // nunca expiraria
+                taskENTER_CRITICAL();
+                expiry_schedule(&reservation_expiry, index, since + timeout);
+                taskEXIT_CRITICAL();
+            }
         }
 
-        vTaskDelay(pdMS_TO_TICKS(250)); // Verifica a cada segundo
+        if (changed)
+            notify_output_tasks(); // Verifica se há notificações pendentes
     }
 }
 
-// Tarefa do display
+// Tarefa do display: resumo, uma tela de grade por zona (ou parte de zona) e a lista de todas as
+// vagas, em rodízio. As linhas ficam alinhadas às páginas de 8 pixels, então a mudança de uma vaga
+// altera (e envia) uma página só; a lista rola mudando a linha inicial do display, um pixel por vez.
 void vDisplayTask(void *pvParameters)
 {
-    ssd1306_t ssd;
-    init_display(&ssd);
+    ssd1306_t *ssd = &display.ssd;
+    init_display(ssd);
+    ssd1306_dma_init(ssd, display_flush_done, xTaskGetCurrentTaskHandle()); // Sem canal livre, o envio segue bloqueante
+
+    static const char *const status_texts[PARKING_STATUS_COUNT + 1] = {"Livre", "Ocupada", "Reservada", "Indefinida"};
+    ssd1306_run_render(&display.title_run, &ssd1306_font_proportional, "Estacionamento", display.title_columns, sizeof(display.title_columns));
+    ssd1306_run_render(&display.label_run, &ssd1306_font_proportional, "livres", display.label_columns, sizeof(display.label_columns));
+    for (int s = 0; s <= PARKING_STATUS_COUNT; s++)
+        ssd1306_run_render(&display.status_runs[s], &ssd1306_font_proportional, status_texts[s], display.status_columns[s], sizeof(display.status_columns[s]));
+    ssd1306_scroller_init(&display.list, PARKING_LOT_SIZE + 1, display_draw_list_row, NULL); // Título e uma linha por vaga
+
+    // A primeira tela é desenhada inteira a partir de uma cópia posterior às vagas pendentes
+    uint32_t dirty[PARKING_BITMAP_WORDS(PARKING_LOT_SIZE)];
+    take_dirty_spots(OUTPUT_DISPLAY, dirty);
+    display.snapshot.zone_counts = display.zone_counts;
+    take_parking_snapshot(&display.snapshot, display.words);
+    display.view = DISPLAY_VIEW_SUMMARY;
+    display_show();
+
+    TickType_t view_deadline = xTaskGetTickCount() + pdMS_TO_TICKS(DISPLAY_PAGE_MS);
+    TickType_t scroll_deadline = view_deadline;
 
     while (1)
     {
-        // Espera por uma notificação
-        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
-
-        ssd1306_fill(&ssd, false); // Limpa a tela
-        draw_centered_text(&ssd, "Estacionamento", 0);
-        ssd1306_draw_string(&ssd, "Vagas:", 0, 15);
+        // O envio anterior precisa terminar antes de o buffer da frente receber as novas páginas;
+        // a tarefa dorme durante a transferência em vez de ocupar a CPU
+        while (ssd1306_busy(ssd))
+            ulTaskNotifyTakeIndexed(DISPLAY_NOTIFY_FLUSH, pdTRUE, portMAX_DELAY);
+        ssd1306_send_data(ssd); // Inicia o envio das páginas alteradas e segue desenhando
+
+        // Espera vagas alteradas até a troca de tela ou o próximo pixel da rolagem
+        bool scrolling = display.view == DISPLAY_VIEW_LIST && ssd1306_scroller_scrolls(&display.list);
+        TickType_t deadline = (scrolling && (int32_t)(scroll_deadline - view_deadline) < 0) ? scroll_deadline : view_deadline;
+        TickType_t now = xTaskGetTickCount();
+        if ((int32_t)(deadline - now) > 0)
+            ulTaskNotifyTake(pdTRUE, deadline - now);
 
-        for (int i = 0; i < PARKING_LOT_SIZE; i++)
+        if (take_dirty_spots(OUTPUT_DISPLAY, dirty))
         {
-            const char *status_text = (parking_lots[i].status == 0) ? "Livre" : (parking_lots[i].status == 1) ? "Ocupada"
-                                                                            : (parking_lots[i].status == 2)   ? "Reservada"
-                                                                                                              : "Indefinida";
+            take_parking_snapshot(&display.snapshot, display.words);
+            display_update(dirty);
+        }
 
-            char buffer[20];
+        now = xTaskGetTickCount();
+        if ((int32_t)(now - view_deadline) >= 0)
+        {
+            view_deadline = now + pdMS_TO_TICKS(display_next_view());
+            scroll_deadline = now + pdMS_TO_TICKS(DISPLAY_PAGE_MS / 2); // A lista para no início antes de rolar
+            display_show();
+        }
+        else if (scrolling && (int32_t)(now - scroll_deadline) >= 0)
+        {
+            ssd1306_scroller_step(ssd, &display.list); // Redesenha só a página que sai pelo topo
+            scroll_deadline = now + pdMS_TO_TICKS(DISPLAY_SCROLL_MS);
+        }
+    }
+}
 
-            snprintf(buffer, sizeof(buffer), "%d: %s", i + 1, status_text);
-            ssd1306_draw_string(&ssd, buffer, 5, (i * 10) + 25);
+// Resumo -> zonas (cada parte da grade) -> lista -> resumo. A lista que rola fica uma volta inteira.
+static uint32_t display_next_view(void)
+{
+    switch (display.view)
+    {
+    case DISPLAY_VIEW_SUMMARY:
+        display.view = DISPLAY_VIEW_ZONE;
+        display.zone = 0;
+        display.chunk = 0;
+        break;
+    case DISPLAY_VIEW_ZONE:
+        if ((display.chunk + 1) * DISPLAY_GRID_CELLS < parking_zones[display.zone].count)
+            display.chunk++;
+        else if (display.zone + 1 < PARKING_ZONES)
+        {
+            display.zone++;
+            display.chunk = 0;
         }
+        else
+            display.view = DISPLAY_VIEW_LIST;
+        break;
+    default:
+        display.view = DISPLAY_VIEW_SUMMARY;
+        break;
+    }
+
+    if (display.view == DISPLAY_VIEW_LIST && ssd1306_scroller_scrolls(&display.list))
+        return DISPLAY_PAGE_MS / 2 + display.list.cycle * 8 * DISPLAY_SCROLL_MS;
+    return DISPLAY_PAGE_MS;
+}
+
+static void display_show(void)
+{
+    ssd1306_t *ssd = &display.ssd;
+    display.last_free = -1;
+    display.last_pcd = -1;
+    memset(display.last_zone, 0xFF, sizeof(display.last_zone));
+
+    if (display.view == DISPLAY_VIEW_LIST)
+    {
+        ssd1306_scroller_show(ssd, &display.list); // Volta a linha inicial para o topo da lista
+        return;
+    }
+
+    ssd1306_set_start_line(ssd, 0); // A lista pode ter deixado a tela rolada
+    ssd1306_fill(ssd, false);
+    if (display.view == DISPLAY_VIEW_SUMMARY)
+    {
+        // Página 0: título; 1-2: total livre em dígitos grandes e PCD; 3-7: uma linha por zona
+        ssd1306_draw_run(ssd, &display.title_run, (WIDTH - display.title_run.width) / 2, 0);
+        ssd1306_draw_run(ssd, &display.label_run, 52, 16);
+        display_draw_summary();
+        return;
+    }
+
+    // Página 0: zona e andar; 1: totais da zona; 2-7: grade com uma célula por vaga
+    const parking_zone_t *zone = &parking_zones[display.zone];
+    int chunks = (zone->count + DISPLAY_GRID_CELLS - 1) / DISPLAY_GRID_CELLS;
+    char title[32];
+    if (chunks > 1) // Sem "Zona" para a parte caber na linha
+        snprintf(title, sizeof(title), "%s, andar %u (%u/%d)", zone->name, zone->floor, display.chunk + 1, chunks);
+    else
+        snprintf(title, sizeof(title), "Zona %s, andar %u", zone->name, zone->floor);
+    ssd1306_draw_text(ssd, &ssd1306_font_proportional, title, 0, 0);
+    display_draw_zone_counts();
+
+    for (int i = 0; i < DISPLAY_GRID_CELLS; i++)
+        display_draw_cell(zone->first + display.chunk * DISPLAY_GRID_CELLS + i);
+}
+
+static void display_update(uint32_t *dirty)
+{
+    int i;
+    switch (display.view)
+    {
+    case DISPLAY_VIEW_SUMMARY:
+        display_draw_summary(); // Só os contadores aparecem no resumo
+        break;
+    case DISPLAY_VIEW_ZONE:
+        display_draw_zone_counts();
+        while ((i = next_dirty_spot(dirty)) >= 0)
+            display_draw_cell(i);
+        break;
+    default:
+        while ((i = next_dirty_spot(dirty)) >= 0)
+            ssd1306_scroller_refresh_row(&display.ssd, &display.list, i + 1);
+        break;
+    }
+}
+
+static void display_draw_summary(void)
+{
+    ssd1306_t *ssd = &display.ssd;
+    int free_total = 0;
+    for (size_t z = 0; z < PARKING_ZONES; z++)
+        free_total += display.zone_counts[z][PARKING_FREE];
+
+    if (free_total != display.last_free) // Total de vagas livres em dígitos de 16 pixels
+    {
+        char free_text[6];
+        snprintf(free_text, sizeof(free_text), "%d", free_total);
+        ssd1306_rect(ssd, 8, 0, 50, 16, false, true);
+        ssd1306_draw_text(ssd, &ssd1306_font_digits_16, free_text, 0, 8);
+        display.last_free = free_total;
+    }
+
+    int pcd = display.snapshot.counts[PARKING_CLASS_PCD][PARKING_FREE];
+    if (pcd != display.last_pcd)
+    {
+        char pcd_text[12];
+        snprintf(pcd_text, sizeof(pcd_text), "PCD: %d", pcd);
+        ssd1306_rect(ssd, 8, 52, WIDTH - 52, 8, false, true);
+        ssd1306_draw_text(ssd, &ssd1306_font_proportional, pcd_text, 52, 8);
+        display.last_pcd = pcd;
+    }
+
+    // Zonas que não cabem nas páginas 3-7 aparecem só nas telas de grade
+    for (size_t z = 0; z < PARKING_ZONES && z < SSD1306_MAX_PAGES - 3; z++)
+    {
+        if (memcmp(display.zone_counts[z], display.last_zone[z], sizeof(display.last_zone[z])) == 0)
+            continue; // Linha igual não suja a página
+
+        char line[24];
+        snprintf(line, sizeof(line), "Zona %s: %u/%u", parking_zones[z].name, // Livres / total
+                 display.zone_counts[z][PARKING_FREE], parking_zones[z].count);
+        ssd1306_rect(ssd, (z + 3) * 8, 0, WIDTH, 8, false, true);
+        ssd1306_draw_text(ssd, &ssd1306_font_proportional, line, 0, (z + 3) * 8);
+        memcpy(display.last_zone[z], display.zone_counts[z], sizeof(display.last_zone[z]));
+    }
+}
+
+static void display_draw_zone_counts(void)
+{
+    const uint16_t *counts = display.zone_counts[display.zone];
+    if (memcmp(counts, display.last_zone[display.zone], sizeof(display.last_zone[0])) == 0)
+        return;
+
+    char line[24];
+    snprintf(line, sizeof(line), "L:%u O:%u R:%u", counts[PARKING_FREE], counts[PARKING_OCCUPIED], counts[PARKING_RESERVED]);
+    ssd1306_rect(&display.ssd, 8, 0, WIDTH, 8, false, true);
+    ssd1306_draw_text(&display.ssd, &ssd1306_font_proportional, line, 0, 8);
+    memcpy(display.last_zone[display.zone], counts, sizeof(display.last_zone[0]));
+}
+
+static void display_draw_cell(int spot)
+{
+    // Livre: contorno; ocupada: cheia; reservada: xadrez; outro valor: ponto
+    static const ssd1306_cell_t cells[PARKING_STATUS_COUNT] = {
+        [PARKING_FREE] = SSD1306_CELL_EMPTY,
+        [PARKING_OCCUPIED] = SSD1306_CELL_FILLED,
+        [PARKING_RESERVED] = SSD1306_CELL_HATCHED,
+    };
+
+    const parking_zone_t *zone = &parking_zones[display.zone];
+    int index = spot - zone->first - display.chunk * DISPLAY_GRID_CELLS;
+    if (display.view != DISPLAY_VIEW_ZONE || spot >= zone->first + zone->count || index < 0 || index >= DISPLAY_GRID_CELLS)
+        return;
 
-        ssd1306_send_data(&ssd);        // Envia os dados para o display
-        vTaskDelay(pdMS_TO_TICKS(100)); // Atualiza a cada 100ms
+    parking_status_t status = parking_snapshot_status(&display.snapshot, spot);
+    ssd1306_grid_cell(&display.ssd, index, (status < PARKING_STATUS_COUNT) ? cells[status] : SSD1306_CELL_DOT, DISPLAY_GRID_PAGE);
+}
+
+// Linha 0: título; linha k: vaga k, sua zona e o status
+static void display_draw_list_row(ssd1306_t *ssd, void *ctx, int row, uint8_t y)
+{
+    ssd1306_rect(ssd, y, 0, WIDTH, 8, false, true);
+    if (row == 0)
+    {
+        ssd1306_draw_run(ssd, &display.title_run, (WIDTH - display.title_run.width) / 2, y);
+        return;
     }
+
+    int spot = row - 1;
+    int zone = parking_zone_of(&parking, spot);
+    parking_status_t status = parking_snapshot_status(&display.snapshot, spot);
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "%d (%s):", spot + 1, (zone >= 0) ? parking_zones[zone].name : "-");
+    uint8_t x = ssd1306_draw_text(ssd, &ssd1306_font_proportional, buffer, 5, y);
+    ssd1306_draw_run(ssd, &display.status_runs[(status < PARKING_STATUS_COUNT) ? status : PARKING_STATUS_COUNT], x + 3, y);
+}
+
+// Chamada na IRQ do DMA ao fim do envio: acorda a tarefa do display
+static void display_flush_done(void *ctx)
+{
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveIndexedFromISR((TaskHandle_t)ctx, DISPLAY_NOTIFY_FLUSH, &woken);
+    portYIELD_FROM_ISR(woken);
 }
 
 // Tarefa do LED
@@ -442,26 +2010,19 @@ void vLedRGBTask(void *pvParameters)
 {
     init_leds(); // Inicializa os LEDs
 
-    int free_parking_lots;
-
     while (1)
     {
-        // Espera por uma notificação
+        // Espera por uma notificação (transição ou troca da vaga selecionada)
         ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
 
-        free_parking_lots = 0;
-
-        // Verifica a quantidade de vagas livres
-        for (int i = 0; i < PARKING_LOT_SIZE; i++)
-        {
-            if (parking_lots[i].status == 0)
-                free_parking_lots++;
-        }
+        // Disponibilidade da zona da vaga selecionada, lida dos contadores da zona
+        int zone = parking_zone_of(&parking, current_parking_lot);
+        int free_parking_lots = parking_zone_count(&parking, zone, PARKING_FREE);
 
-        // Acende uma cor no LED RGB de acordo com a quantidade de vagas livres
+        // Acende uma cor no LED RGB de acordo com a quantidade de vagas livres na zona
         if (free_parking_lots == 0)
             set_led_red();
-        else if (free_parking_lots > PARKING_LOT_SIZE / 2)
+        else if (free_parking_lots > parking_zones[zone].count / 2)
         {
             set_led_green();
         }
@@ -478,42 +2039,95 @@ void vBuzzerTask(void *pvParameters)
     // Inicializa o buzzer
     init_buzzer(BUZZER_A_PIN, 4.0);
 
-    int parking_lot_status[PARKING_LOT_SIZE] = {0};
+    uint32_t dirty[PARKING_BITMAP_WORDS(PARKING_LOT_SIZE)];
+    uint32_t words[PARKING_STORE_WORDS(PARKING_LOT_SIZE)];
+    parking_snapshot_t snapshot = {0};
 
     while (1)
     {
         // Espera por uma notificação
         ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
 
-        // Verifica qual foi a mudança de status
-        for (int i = 0; i < PARKING_LOT_SIZE; i++)
+        if (!take_dirty_spots(OUTPUT_BUZZER, dirty))
+            continue;
+
+        take_parking_snapshot(&snapshot, words);
+
+        // Toca um aviso por vaga alterada, de acordo com o novo status
+        int i;
+        while ((i = next_dirty_spot(dirty)) >= 0)
         {
-            if (parking_lots[i].status != parking_lot_status[i])
+            parking_status_t status = parking_snapshot_status(&snapshot, i);
+
+            // Toca o buzzer se a vaga estiver ocupada
+            if (status == PARKING_OCCUPIED)
             {
-                parking_lot_status[i] = parking_lots[i].status;
+                play_tone(BUZZER_A_PIN, 300);
+                vTaskDelay(pdMS_TO_TICKS(250));
+                stop_tone(BUZZER_A_PIN);
+            }
+            // Toca o buzzer se a vaga estiver livre
+            else if (status == PARKING_FREE)
+            {
+                play_tone(BUZZER_A_PIN, 2000);
+                vTaskDelay(pdMS_TO_TICKS(250));
+                stop_tone(BUZZER_A_PIN);
+            }
+            // Toca o buzzer se a vaga estiver reservada
+            else if (status == PARKING_RESERVED)
+            {
+                play_tone(BUZZER_A_PIN, 900);
+                vTaskDelay(pdMS_TO_TICKS(250));
+                stop_tone(BUZZER_A_PIN);
+            }
+        }
+    }
+}
 
-                // Toca o buzzer se a vaga estiver ocupada
-                if (parking_lots[i].status == 1)
-                {
-                    play_tone(BUZZER_A_PIN, 300);
-                    vTaskDelay(pdMS_TO_TICKS(250));
-                    stop_tone(BUZZER_A_PIN);
-                }
-                // Toca o buzzer se a vaga estiver livre
-                else if (parking_lots[i].status == 0)
-                {
-                    play_tone(BUZZER_A_PIN, 2000);
-                    vTaskDelay(pdMS_TO_TICKS(250));
-                    stop_tone(BUZZER_A_PIN);
-                }
-                // Toca o buzzer se a vaga estiver reservada
-                else if (parking_lots[i].status == 2)
-                {
-                    play_tone(BUZZER_A_PIN, 900);
-                    vTaskDelay(pdMS_TO_TICKS(250));
-                    stop_tone(BUZZER_A_PIN);
-                }
+// Tarefa da flash: lê o diário em lotes e grava as transições no log, longe das tarefas de entrada
+void vFlashLogTask(void *pvParameters)
+{
+    uint32_t next_seq = journal_oldest(&parking_journal); // Inclui as transições feitas antes da primeira leitura
+    TickType_t last_flush = xTaskGetTickCount();
+    bool resync = false;
+
+    while (1)
+    {
+        vTaskDelay(pdMS_TO_TICKS(FLASH_LOG_POLL_MS));
+
+        uint32_t head = journal_head(&parking_journal);
+        while (next_seq != head && !resync)
+        {
+            journal_record_t record;
+            journal_result_t result = journal_read(&parking_journal, next_seq, &record);
+
+            if (result == JOURNAL_PENDING)
+                break; // Escritor no meio do registro: continua na próxima rodada
+            if (result == JOURNAL_LOST)
+            {
+                resync = true; // O anel deu a volta: grava o estado completo
+                break;
             }
+            next_seq++;
+
+            // Grava o status atual da vaga, não o do registro: registros de escritores concorrentes
+            // podem sair de ordem no diário, mas o último gravado sempre reflete o armazenamento
+            parking_status_t status = parking_get_status(&parking, record.spot);
+            if (flash_log_state[record.spot] != status && !flashlog_append(&flash_log, record.spot, status))
+                resync = true;
+        }
+
+        if (resync)
+        {
+            next_seq = journal_head(&parking_journal);
+            resync = !sync_flash_log();
+            last_flush = xTaskGetTickCount();
+        }
+        else if (flashlog_pending(&flash_log) &&
+                 (xTaskGetTickCount() - last_flush) >= pdMS_TO_TICKS(FLASH_LOG_FLUSH_MS))
+        {
+            flashlog_flush(&flash_log);
+            last_flush = xTaskGetTickCount();
         }
     }
 }
@@ -521,6 +2135,8 @@ void vBuzzerTask(void *pvParameters)
 // Verifica se há notificações pendentes
 void notify_output_tasks()
 {
+    atomic_fetch_add_explicit(&parking_state_version, 1, memory_order_release); // Invalida o cache da página de status; chamada por várias tarefas
+
     if (xDisplayTaskHandle != NULL)
     {
         xTaskNotifyGive(xDisplayTaskHandle);
@@ -540,4 +2156,9 @@ void notify_output_tasks()
     {
         xTaskNotifyGive(xBuzzerTaskHandle);
     }
+
+    if (xWebServerTaskHandle != NULL)
+    {
+        xTaskNotifyGive(xWebServerTaskHandle);
+    }
 }
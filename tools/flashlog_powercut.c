@@ -0,0 +1,259 @@
+// Teste de corte de energia do log das vagas na flash (lib/parking/flashlog.c) no computador: a flash
+// é simulada em RAM (programar só muda bits de 1 para 0, apagar volta o setor para 0xFF) e uma carga
+// fixa de transições é repetida cortando a energia depois de N bytes programados ou apagados, para
+// cada N. O byte em que o corte acontece fica com parte dos bits gravados; um apagamento interrompido
+// deixa bytes aleatórios do setor ainda com o conteúdo antigo. Depois do corte o log é montado de
+// novo (com outro corte no meio da recuperação e depois sem cortes) e o estado recuperado precisa ser
+// o de algum ponto da carga entre a última gravação confirmada e a última transição registrada.
+//
+// Uso: gcc -O2 -Wall -Ilib/parking tools/flashlog_powercut.c lib/parking/flashlog.c -o flashlog_powercut
+//      ./flashlog_powercut [setores] [transições] [passo]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "flashlog.h"
+
+#define SPOTS 4        // Vagas, como PARKING_LOT_SIZE
+#define FLUSH_EVERY 37 // Transições entre flushes, como o flush periódico do vFlashLogTask
+#define MAX_SECTORS 16
+
+// Flash em RAM com orçamento de bytes até o corte de energia
+typedef struct ram_flash {
+  uint8_t data[MAX_SECTORS * FLASHLOG_SECTOR_SIZE];
+  uint32_t size;
+  long budget;    // Bytes que ainda podem ser programados ou apagados (< 0: sem corte)
+  long written;   // Bytes programados ou apagados desde o boot
+  bool powered;   // Falso depois do corte: todo acesso falha
+  unsigned noise; // Semente dos bits que sobram no byte do corte
+} ram_flash_t;
+
+static unsigned noise_next(ram_flash_t *flash)
+{
+  flash->noise = flash->noise * 1103515245u + 12345u;
+  return flash->noise >> 16;
+}
+
+// Consome um byte do orçamento; falso se a energia acaba neste byte
+static bool ram_flash_spend(ram_flash_t *flash)
+{
+  flash->written++;
+  if (flash->budget < 0)
+    return true;
+  if (flash->budget == 0) {
+    flash->powered = false;
+    return false;
+  }
+  flash->budget--;
+  return true;
+}
+
+static bool ram_read(void *ctx, uint32_t offset, void *dst, size_t len)
+{
+  ram_flash_t *flash = ctx;
+  if (!flash->powered || offset + len > flash->size)
+    return false;
+  memcpy(dst, &flash->data[offset], len);
+  return true;
+}
+
+static bool ram_program(void *ctx, uint32_t offset, const void *src, size_t len)
+{
+  ram_flash_t *flash = ctx;
+  const uint8_t *bytes = src;
+
+  if (!flash->powered || offset % FLASHLOG_PAGE_SIZE || len != FLASHLOG_PAGE_SIZE || offset + len > flash->size)
+    return false;
+
+  for (size_t i = 0; i < len; i++) {
+    if (!ram_flash_spend(flash)) {
+      flash->data[offset + i] &= bytes[i] | (uint8_t)noise_next(flash); // Só parte dos bits chegou a zero
+      return false;
+    }
+    flash->data[offset + i] &= bytes[i];
+  }
+  return true;
+}
+
+static bool ram_erase(void *ctx, uint32_t offset)
+{
+  ram_flash_t *flash = ctx;
+
+  if (!flash->powered || offset % FLASHLOG_SECTOR_SIZE || offset + FLASHLOG_SECTOR_SIZE > flash->size)
+    return false;
+
+  for (uint32_t i = 0; i < FLASHLOG_SECTOR_SIZE; i++) {
+    if (!ram_flash_spend(flash)) {
+      // Apagamento interrompido: cada byte restante pode ter sido apagado ou não
+      for (; i < FLASHLOG_SECTOR_SIZE; i++)
+        if (noise_next(flash) & 1)
+          flash->data[offset + i] = 0xFF;
+      return false;
+    }
+  }
+  memset(&flash->data[offset], 0xFF, FLASHLOG_SECTOR_SIZE);
+  return true;
+}
+
+// Liga a flash com um orçamento de bytes (< 0: sem corte)
+static void ram_flash_boot(ram_flash_t *flash, long budget)
+{
+  flash->budget = budget;
+  flash->written = 0;
+  flash->powered = true;
+}
+
+// Estado esperado depois de cada transição da carga (history[k]: depois de k transições)
+static uint8_t history[100000][SPOTS];
+
+// Transição k da carga: sempre muda o status de alguma vaga, como as do diário
+static void workload_step(int k, const uint8_t *state, uint16_t *index, uint8_t *status)
+{
+  unsigned x = (unsigned)k * 2654435761u;
+  *index = (uint16_t)((x >> 8) % SPOTS);
+  *status = (uint8_t)((state[*index] + 1 + (x >> 16) % 2) % 3);
+}
+
+// Roda a carga até o fim ou até o corte; retorna quantas transições foram registradas e, em
+// *durable, quantas já estavam garantidas na flash
+static int run_workload(ram_flash_t *flash, uint32_t sectors, int transitions, int *durable)
+{
+  flashlog_io_t io = {.ctx = flash, .read = ram_read, .program = ram_program, .erase = ram_erase};
+  uint8_t state[SPOTS];
+  flashlog_t log;
+  flashlog_init(&log, &io, sectors, state, SPOTS);
+
+  *durable = 0;
+  flashlog_mount(&log);
+  if (!flash->powered)
+    return 0;
+
+  int done = 0;
+  while (done < transitions) {
+    uint16_t index;
+    uint8_t status;
+    workload_step(done, history[done], &index, &status);
+
+    bool ok = flashlog_append(&log, index, status);
+    if (!flash->powered)
+      return done + 1; // A transição pode ou não ter chegado à flash
+    if (!ok)
+      return -1;
+    done++;
+
+    if (done % FLUSH_EVERY == 0 && !flashlog_flush(&log))
+      return flash->powered ? -1 : done;
+    if (!flashlog_pending(&log))
+      *durable = done;
+  }
+
+  if (!flashlog_flush(&log))
+    return flash->powered ? -1 : done;
+  *durable = done;
+  return done;
+}
+
+// Monta o log como no boot; falso se a energia acabou durante a recuperação
+static bool mount(ram_flash_t *flash, uint32_t sectors, uint8_t *state)
+{
+  flashlog_io_t io = {.ctx = flash, .read = ram_read, .program = ram_program, .erase = ram_erase};
+  flashlog_t log;
+  flashlog_init(&log, &io, sectors, state, SPOTS);
+  flashlog_mount(&log);
+  return flash->powered;
+}
+
+// O estado recuperado precisa ser o de algum ponto entre durable e registered
+static int match_history(const uint8_t *state, int durable, int registered)
+{
+  for (int k = registered; k >= durable; k--)
+    if (memcmp(state, history[k], SPOTS) == 0)
+      return k;
+  return -1;
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t sectors = (argc > 1) ? (uint32_t)atoi(argv[1]) : 2;
+  int transitions = (argc > 2) ? atoi(argv[2]) : 1500;
+  long step = (argc > 3) ? atol(argv[3]) : 1;
+
+  if (sectors < 2 || sectors > MAX_SECTORS || transitions < 1 ||
+      transitions >= (int)(sizeof(history) / sizeof(history[0])) || step < 1) {
+    fprintf(stderr, "uso: %s [setores 2..%d] [transições] [passo]\n", argv[0], MAX_SECTORS);
+    return 2;
+  }
+
+  static ram_flash_t flash;
+  flash.size = sectors * FLASHLOG_SECTOR_SIZE;
+
+  // Histórico da carga e total de bytes gravados sem corte
+  memset(history[0], 0, SPOTS);
+  for (int k = 0; k < transitions; k++) {
+    uint16_t index;
+    uint8_t status;
+    workload_step(k, history[k], &index, &status);
+    memcpy(history[k + 1], history[k], SPOTS);
+    history[k + 1][index] = status;
+  }
+
+  int durable;
+  memset(flash.data, 0xFF, flash.size);
+  ram_flash_boot(&flash, -1);
+  if (run_workload(&flash, sectors, transitions, &durable) != transitions || durable != transitions) {
+    fprintf(stderr, "a carga sem corte não terminou com tudo gravado\n");
+    return 1;
+  }
+  long total = flash.written;
+
+  long cuts = 0, recovery_cuts = 0, failures = 0;
+  for (long cut = 0; cut < total; cut += step) {
+    memset(flash.data, 0xFF, flash.size);
+    flash.noise = (unsigned)cut;
+    ram_flash_boot(&flash, cut);
+    int registered = run_workload(&flash, sectors, transitions, &durable);
+    if (registered < 0) {
+      fprintf(stderr, "corte em %ld: escrita recusada sem corte\n", cut);
+      failures++;
+      continue;
+    }
+    cuts++;
+
+    // Segundo corte no meio da recuperação, em um ponto que varia com o primeiro
+    uint8_t state[SPOTS];
+    ram_flash_boot(&flash, (long)(cut * 7919 % (2 * FLASHLOG_SECTOR_SIZE)));
+    if (!mount(&flash, sectors, state))
+      recovery_cuts++;
+
+    ram_flash_boot(&flash, -1);
+    mount(&flash, sectors, state);
+    int k = match_history(state, durable, registered);
+    if (k < 0) {
+      fprintf(stderr, "corte em %ld: estado recuperado {%d,%d,%d,%d} fora das transições %d..%d\n", cut,
+              state[0], state[1], state[2], state[3], durable, registered);
+      failures++;
+      continue;
+    }
+
+    // O log recuperado continua utilizável: uma transição nova sobrevive a outra montagem
+    flashlog_io_t io = {.ctx = &flash, .read = ram_read, .program = ram_program, .erase = ram_erase};
+    flashlog_t log;
+    uint8_t expected[SPOTS];
+    flashlog_init(&log, &io, sectors, state, SPOTS);
+    flashlog_mount(&log);
+    state[0] = (uint8_t)((state[0] + 1) % 3);
+    memcpy(expected, state, SPOTS);
+    flashlog_append(&log, 0, state[0]);
+    flashlog_flush(&log);
+    mount(&flash, sectors, state);
+    if (memcmp(state, expected, SPOTS) != 0) {
+      fprintf(stderr, "corte em %ld: transição depois da recuperação perdida\n", cut);
+      failures++;
+    }
+  }
+
+  printf("%u setores, %d transições, %ld bytes gravados por carga\n", sectors, transitions, total);
+  printf("%ld cortes testados (%ld também na recuperação), %ld falhas\n", cuts, recovery_cuts, failures);
+  return failures ? 1 : 0;
+}
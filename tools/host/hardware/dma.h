@@ -0,0 +1,29 @@
+// Substituto mínimo do hardware/dma.h: não há canais no computador, então o envio fica bloqueante
+#ifndef HOST_HARDWARE_DMA_H
+#define HOST_HARDWARE_DMA_H
+
+#include "pico/stdlib.h"
+
+#define NUM_DMA_CHANNELS 12
+
+enum dma_channel_transfer_size { DMA_SIZE_8, DMA_SIZE_16, DMA_SIZE_32 };
+
+typedef struct {
+  uint32_t ctrl;
+} dma_channel_config;
+
+static inline int dma_claim_unused_channel(bool required) { return -1; }
+static inline void dma_channel_unclaim(uint channel) {}
+static inline dma_channel_config dma_channel_get_default_config(uint channel) { return (dma_channel_config){0}; }
+static inline void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size) {}
+static inline void channel_config_set_read_increment(dma_channel_config *c, bool incr) {}
+static inline void channel_config_set_write_increment(dma_channel_config *c, bool incr) {}
+static inline void channel_config_set_dreq(dma_channel_config *c, uint dreq) {}
+static inline void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                                         const volatile void *read_addr, uint count, bool trigger) {}
+static inline void dma_channel_transfer_from_buffer_now(uint channel, const volatile void *read_addr, uint count) {}
+static inline void dma_channel_set_irq1_enabled(uint channel, bool enabled) {}
+static inline bool dma_channel_get_irq1_status(uint channel) { return false; }
+static inline void dma_channel_acknowledge_irq1(uint channel) {}
+
+#endif // HOST_HARDWARE_DMA_H
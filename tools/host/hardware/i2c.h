@@ -0,0 +1,24 @@
+// Substituto mínimo do hardware/i2c.h: a ferramenta fornece i2c_write_blocking; o controlador é só memória
+#ifndef HOST_HARDWARE_I2C_H
+#define HOST_HARDWARE_I2C_H
+
+#include "pico/stdlib.h"
+
+#define I2C_IC_DATA_CMD_STOP_BITS 0x00000200
+
+typedef struct i2c_inst i2c_inst_t;
+
+typedef struct {
+  volatile uint32_t enable, tar, data_cmd, clr_tx_abrt;
+} i2c_hw_t;
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+
+static inline i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c) {
+  static i2c_hw_t hw;
+  return &hw;
+}
+
+static inline uint i2c_get_dreq(i2c_inst_t *i2c, bool is_tx) { return 0; }
+
+#endif // HOST_HARDWARE_I2C_H
@@ -0,0 +1,17 @@
+// Substituto mínimo do lwip/apps/fs.h para compilar no computador o fsdata_custom.c gerado por
+// tools/makefsdata.py (ferramentas em tools/)
+#ifndef HOST_LWIP_APPS_FS_H
+#define HOST_LWIP_APPS_FS_H
+
+#define FS_FILE_FLAGS_HEADER_INCLUDED 0x01
+#define FS_FILE_FLAGS_HEADER_PERSISTENT 0x02
+
+struct fsdata_file {
+  const struct fsdata_file *next;
+  const unsigned char *name;
+  const unsigned char *data;
+  int len;
+  unsigned char flags;
+};
+
+#endif // HOST_LWIP_APPS_FS_H
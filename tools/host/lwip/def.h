@@ -0,0 +1,4 @@
+// Substituto mínimo do lwip/def.h (incluído pelo fsdata_custom.c gerado por tools/makefsdata.py)
+#ifndef HOST_LWIP_DEF_H
+#define HOST_LWIP_DEF_H
+#endif // HOST_LWIP_DEF_H
@@ -0,0 +1,13 @@
+// Substituto mínimo do pico/stdlib.h para compilar bibliotecas no computador (ferramentas em tools/)
+#ifndef HOST_PICO_STDLIB_H
+#define HOST_PICO_STDLIB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+static inline void tight_loop_contents(void) {}
+
+#endif // HOST_PICO_STDLIB_H
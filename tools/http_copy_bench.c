@@ -0,0 +1,220 @@
+// Bytes copiados para os buffers do lwIP (heap de MEM_SIZE) por resposta, nos caminhos que o
+// firmware usa hoje: arquivos do sistema de arquivos do httpd enviados por referência da flash,
+// /api/status (cabeçalho e JSON copiados), 304, abertura do SSE e eventos SSE/WebSocket. A linha
+// "página copiada" é o ponto de partida: a página inteira formatada no firmware e copiada a cada
+// recarga (a cada 5 s). Um tcp_write simulado conta os bytes com e sem cópia.
+//
+// Os arquivos vêm do fsdata_custom.c gerado por tools/makefsdata.py e os cabeçalhos de
+// public/html_data.h; o JSON segue o formato de render_status_json com as zonas de src/main.c.
+//
+// Uso: python3 tools/makefsdata.py /tmp/fsdata/fsdata_custom.c public/index.html public/style.css public/app.js
+//      gcc -O2 -Wall -I. -Itools/host -I/tmp/fsdata tools/http_copy_bench.c -o http_copy_bench
+//      ./http_copy_bench [respostas]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lwip/apps/fs.h"
+#include "fsdata_custom.c"
+#include "public/html_data.h"
+
+#define PARKING_LOT_SIZE 4
+#define MEM_SIZE 4000 // config/lwipopts_examples_common.h
+#define TCP_WRITE_FLAG_COPY 0x01
+#define TCP_WRITE_FLAG_MORE 0x02
+
+static const char html_header[] =
+"HTTP/1.1 200 OK\r\n"
+"Content-Type: text/html\r\n"
+/* "Content-Length: 2220\r\n" // Substitua 1234 pelo tamanho real do conteúdo HTML
+"Connection: close\r\n" */
+"\r\n"
+"<!DOCTYPE html><html lang=\"pt-br\"><head><meta charset=\"UTF-8\"><title>Estacionamento Inteligente</title>"
+"<style>body{font-family:Arial,sans-serif;background:#f4f4f4;margin:0;padding:0;}.container{max-width:600px;margin:20px auto;padding:10px;background:#fff;border-radius:6px;box-shadow:0 2px 6px #0001;}h1{text-align:center;color:#222;}.content{display:grid;grid-template-columns:1fr 1fr;gap:10px;margin-top:20px;}.box{background:#e9e9e9;padding:10px;border-radius:4px;text-align:center;}.pcd{border:2px dashed #2196F3;background:#E3F2FD;position:relative;}.vaga-tipo{font-weight:bold;margin-bottom:6px;}.btn-reservar{background:#4CAF50;color:#fff;padding:6px 12px;border:none;border-radius:3px;cursor:pointer;margin-top:8px;}.btn-reservar:disabled{background:#bbb;cursor:not-allowed;}.status-indicator{width:14px;height:14px;border-radius:50%;display:inline-block;margin-bottom:6px;}.disponivel{background:#4CAF50;}.ocupada{background:#f44336;}.reservada{background:#ff9800;}.status-text{font-size:0.9em;color:#555;margin:4px 0;}</style></head><body>"
+"<div class=\"container\"><h1>Estacionamento Inteligente</h1><div class=\"content\">";
+
+// Fragmento de uma vaga: classe PCD, classe do status, número, sufixo PCD, tipo, status, número e botão
+static const char html_spot[] =
+"<div class=\"box %s\"><div class=\"status-indicator %s\"></div><div class=\"vaga-tipo\">Vaga %d%s</div><p>%s</p><p class=\"status-text\">%s</p><form action=\"./reservar-vaga-%d\"><button class=\"btn-reservar\" %s>Reservar</button></form></div>";
+
+static const char html_footer[] =
+"</div></div><script>setTimeout(()=>{window.location.href = '/';},5000);</script></body></html>";
+
+// tcp_write simulado: com cópia os bytes vão para o heap do lwIP (MEM_SIZE), sem cópia só a referência
+typedef struct bench_tcp {
+  size_t writes;
+  size_t copied;
+  size_t referenced;
+} bench_tcp_t;
+
+static bench_tcp_t bench_tcp;
+static char bench_sink[4096];
+
+static void tcp_write(const void *data, size_t len, uint8_t flags)
+{
+  bench_tcp.writes++;
+  if (flags & TCP_WRITE_FLAG_COPY) {
+    memcpy(bench_sink, data, len < sizeof(bench_sink) ? len : sizeof(bench_sink));
+    bench_tcp.copied += len;
+  } else {
+    bench_tcp.referenced += len;
+  }
+}
+
+static const char *const status_class[] = {"disponivel", "ocupada", "reservada"};
+static const char *const status_text[] = {"Disponível", "Ocupada", "Reservada"};
+static const char *const disabled_btn[] = {"", "disabled", "disabled"};
+static const uint8_t spot_status[PARKING_LOT_SIZE] = {0, 1, 2, 0};
+static const uint8_t spot_pcd[PARKING_LOT_SIZE] = {0, 0, 0, 1};
+
+static int render_spot(char *buffer, size_t size, int i)
+{
+  int len = snprintf(buffer, size, html_spot, spot_pcd[i] ? "pcd" : "", status_class[spot_status[i]], i + 1,
+                     spot_pcd[i] ? " - PCD" : "", spot_pcd[i] ? "Vaga exclusiva para PCD" : "Vaga comum",
+                     status_text[spot_status[i]], i + 1, disabled_btn[spot_status[i]]);
+  return (len < 0) ? 0 : ((size_t)len >= size ? (int)size - 1 : len);
+}
+
+// Antes: a página inteira formatada em um buffer da pilha e copiada (html_header/html_spot/html_footer
+// eram os fragmentos de public/html_data.h quando a página era montada no firmware)
+static void send_full_copy(void)
+{
+  char html[3000];
+  size_t pos = strlen(html_header);
+  memcpy(html, html_header, pos);
+  for (int i = 0; i < PARKING_LOT_SIZE; i++)
+    pos += render_spot(html + pos, sizeof(html) - pos, i);
+  pos += snprintf(html + pos, sizeof(html) - pos, "%s", html_footer);
+  tcp_write(html, pos, TCP_WRITE_FLAG_COPY);
+}
+
+// Arquivo do sistema de arquivos do httpd pelo nome, como fs_open
+static const struct fsdata_file *find_file(const char *name)
+{
+  for (const struct fsdata_file *f = FS_ROOT; f; f = f->next)
+    if (strcmp((const char *)f->name, name) == 0)
+      return f;
+  fprintf(stderr, "%s não está no fsdata_custom.c\n", name);
+  exit(1);
+}
+
+static const struct fsdata_file *file_index, *file_style, *file_app;
+
+// send_static_file: o arquivo inteiro (cabeçalho + corpo gzip) por referência
+static void send_index(void) { tcp_write(file_index->data, file_index->len, 0); }
+static void send_style(void) { tcp_write(file_style->data, file_style->len, 0); }
+static void send_app(void) { tcp_write(file_app->data, file_app->len, 0); }
+
+// Estado das vagas como render_status_json o monta (zonas A e B em dois andares, versão com boot_id)
+static char json_cache[256];
+static int json_cache_len;
+
+static void render_json(void)
+{
+  json_cache_len = snprintf(json_cache, sizeof(json_cache),
+                            "{\"v\":\"%08lx-%lu\",\"s\":[%d,%d,%d,%d],\"pcd\":[%d,%d,%d,%d],"
+                            "\"zones\":[{\"n\":\"A\",\"f\":0,\"c\":[1,1,0]},{\"n\":\"B\",\"f\":1,\"c\":[1,0,1]}],"
+                            "\"floors\":[[1,1,0],[1,0,1]]}",
+                            0x9e3779b9ul, 1234ul, spot_status[0], spot_status[1], spot_status[2], spot_status[3],
+                            spot_pcd[0], spot_pcd[1], spot_pcd[2], spot_pcd[3]);
+}
+
+static const char etag[] = "\"9e3779b9-1234\"";
+
+// send_api_status: cabeçalho e JSON copiados
+static void send_status(void)
+{
+  char header[192];
+  int len = snprintf(header, sizeof(header), api_status_header, etag, json_cache_len, "keep-alive");
+  tcp_write(header, len, TCP_WRITE_FLAG_COPY | TCP_WRITE_FLAG_MORE);
+  tcp_write(json_cache, json_cache_len, TCP_WRITE_FLAG_COPY);
+}
+
+// send_api_status com o If-None-Match atual: só o cabeçalho 304
+static void send_status_304(void)
+{
+  char header[128];
+  int len = snprintf(header, sizeof(header), http_not_modified, etag, "keep-alive");
+  tcp_write(header, len, TCP_WRITE_FLAG_COPY);
+}
+
+// open_sse_stream: cabeçalho constante por referência e o estado completo copiado no primeiro evento
+static void send_sse_open(void)
+{
+  tcp_write(sse_header, sizeof(sse_header) - 1, TCP_WRITE_FLAG_MORE);
+  tcp_write("data: ", 6, TCP_WRITE_FLAG_MORE);
+  tcp_write(json_cache, json_cache_len, TCP_WRITE_FLAG_COPY | TCP_WRITE_FLAG_MORE);
+  tcp_write("\n\n", 2, 0);
+}
+
+static char event[112];
+static int event_len;
+
+// push_state_events: um evento por vaga alterada, copiado para cada cliente
+static void send_sse_event(void) { tcp_write(event, event_len, TCP_WRITE_FLAG_COPY); }
+
+// ws_send: cabeçalho do quadro e payload copiados
+static void send_ws_event(void)
+{
+  uint8_t header[2] = {0x81, (uint8_t)(event_len - 8)};
+  tcp_write(header, sizeof(header), TCP_WRITE_FLAG_COPY | TCP_WRITE_FLAG_MORE);
+  tcp_write(event + 6, event_len - 8, TCP_WRITE_FLAG_COPY);
+}
+static uint64_t bench_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+int main(int argc, char **argv)
+{
+  int responses = (argc > 1) ? atoi(argv[1]) : 100000;
+  if (responses < 1)
+    responses = 1;
+
+  file_index = find_file("/index.html");
+  file_style = find_file("/style.css");
+  file_app = find_file("/app.js");
+  render_json();
+  event_len = snprintf(event, sizeof(event), "data: {\"v\":\"%08lx-%lu\",\"id\":%d,\"s\":%d,\"z\":%d,\"zc\":[%u,%u,%u]}\n\n",
+                       0x9e3779b9ul, 1235ul, 3, 2, 1, 1u, 0u, 1u);
+
+  static const struct {
+    const char *name;
+    void (*send)(void);
+  } variants[] = {
+    {"página copiada", send_full_copy},
+    {"GET /", send_index},
+    {"GET /style.css", send_style},
+    {"GET /app.js", send_app},
+    {"/api/status", send_status},
+    {"/api/status 304", send_status_304},
+    {"abertura SSE", send_sse_open},
+    {"evento SSE", send_sse_event},
+    {"evento WS", send_ws_event},
+  };
+
+  printf("%-16s %8s %8s %12s %10s %12s\n", "versão", "writes", "copiado", "referenciado", "ns/resp", "resp/MEM_SIZE");
+  for (size_t v = 0; v < sizeof(variants) / sizeof(variants[0]); v++) {
+    bench_tcp = (bench_tcp_t){0};
+    variants[v].send();
+    bench_tcp_t one = bench_tcp;
+
+    uint64_t start = bench_ns();
+    for (int r = 0; r < responses; r++)
+      variants[v].send();
+    uint64_t elapsed = (bench_ns() - start) / responses;
+
+    // Respostas que cabem juntas no heap do lwIP; sem cópia o limite é o TCP_SND_QUEUELEN, não o MEM_SIZE
+    char fit[16] = "-";
+    if (one.copied)
+      snprintf(fit, sizeof(fit), "%zu", MEM_SIZE / one.copied);
+    printf("%-16s %8zu %8zu %12zu %10llu %12s\n", variants[v].name, one.writes, one.copied, one.referenced,
+           (unsigned long long)elapsed, fit);
+  }
+  return 0;
+}
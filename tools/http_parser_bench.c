@@ -0,0 +1,136 @@
+// Vazão do parser incremental de requisições HTTP no computador: alimenta lib/http/http_parser.c com
+// requisições inteiras e divididas em segmentos (como chegam em pbufs encadeados ou em vários
+// segmentos TCP) e compara com a versão antiga, que copiava a requisição para o heap e procurava
+// cada rota com strstr. Confere também que todas as divisões produzem o mesmo resultado.
+//
+// Uso: gcc -O2 -Wall -Ilib/http tools/http_parser_bench.c lib/http/http_parser.c -o http_parser_bench
+//      ./http_parser_bench [requisições]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "http_parser.h"
+
+#define PARKING_LOT_SIZE 4
+
+static uint64_t bench_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+// Requisição de um navegador (cabeçalhos longos) e de um cliente mínimo
+static const char request_browser[] =
+  "GET /reservar-vaga-3 HTTP/1.1\r\n"
+  "Host: 192.168.0.42\r\n"
+  "Connection: keep-alive\r\n"
+  "Upgrade-Insecure-Requests: 1\r\n"
+  "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0.0.0 Safari/537.36\r\n"
+  "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,*/*;q=0.8\r\n"
+  "Referer: http://192.168.0.42/\r\n"
+  "Accept-Encoding: gzip, deflate\r\n"
+  "Accept-Language: pt-BR,pt;q=0.9,en-US;q=0.8,en;q=0.7\r\n"
+  "If-None-Match: \"v42\"\r\n"
+  "\r\n";
+
+static const char request_minimal[] =
+  "GET /reservar-vaga-3 HTTP/1.1\r\n"
+  "Host: 192.168.0.42\r\n"
+  "\r\n";
+
+static volatile int bench_result; // Evita que o compilador descarte o trabalho medido
+
+// Versão antiga: cópia no heap e uma busca por rota em toda a requisição
+static int old_parse(const char *data, size_t len)
+{
+  char *request = malloc(len + 1);
+  memcpy(request, data, len);
+  request[len] = '\0';
+
+  int spot = -1;
+  for (int i = 0; i < PARKING_LOT_SIZE; i++) {
+    char endpoint[25];
+    snprintf(endpoint, sizeof(endpoint), "GET /reservar-vaga-%d", i + 1);
+    if (strstr(request, endpoint) != NULL) {
+      spot = i;
+      break;
+    }
+  }
+  free(request);
+  return spot;
+}
+
+// Parser incremental: a requisição chega em segmentos de "segment" bytes (0: inteira)
+static int new_parse(http_parser_t *parser, const char *data, size_t len, size_t segment)
+{
+  http_parser_init(parser);
+  size_t pos = 0;
+  while (pos < len && parser->state != HTTP_STATE_DONE && parser->state != HTTP_STATE_ERROR) {
+    size_t n = (segment && len - pos > segment) ? segment : len - pos;
+    pos += http_parser_feed(parser, data + pos, n);
+  }
+  return parser->state == HTTP_STATE_DONE ? parser->path_len : -1;
+}
+
+typedef struct bench_case {
+  const char *name;
+  const char *request;
+  size_t len;
+} bench_case_t;
+
+int main(int argc, char **argv)
+{
+  int requests = (argc > 1) ? atoi(argv[1]) : 200000;
+  if (requests < 1)
+    requests = 1;
+
+  static const bench_case_t cases[] = {
+    {"navegador", request_browser, sizeof(request_browser) - 1},
+    {"mínima", request_minimal, sizeof(request_minimal) - 1},
+  };
+  static const size_t segments[] = {0, 536, 64, 7, 1};
+
+  // Todas as divisões precisam chegar ao mesmo resultado da requisição inteira
+  for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+    http_parser_t whole, split;
+    new_parse(&whole, cases[c].request, cases[c].len, 0);
+    for (size_t s = 1; s < sizeof(segments) / sizeof(segments[0]); s++) {
+      new_parse(&split, cases[c].request, cases[c].len, segments[s]);
+      if (whole.state != HTTP_STATE_DONE || split.state != HTTP_STATE_DONE || strcmp(whole.path, split.path) != 0 ||
+          strcmp(whole.etag, split.etag) != 0 || whole.connection_keep_alive != split.connection_keep_alive) {
+        fprintf(stderr, "%s: resultado diferente com segmentos de %zu bytes\n", cases[c].name, segments[s]);
+        return 1;
+      }
+    }
+  }
+
+  printf("%-10s %6s %-16s %10s %10s\n", "requisição", "bytes", "versão", "ns/req", "MB/s");
+  for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+    uint64_t start = bench_ns();
+    for (int r = 0; r < requests; r++)
+      bench_result = old_parse(cases[c].request, cases[c].len);
+    uint64_t elapsed = bench_ns() - start;
+    printf("%-10s %6zu %-16s %10.1f %10.1f\n", cases[c].name, cases[c].len, "malloc+strstr",
+           (double)elapsed / requests, (double)cases[c].len * requests * 1000.0 / elapsed);
+
+    for (size_t s = 0; s < sizeof(segments) / sizeof(segments[0]); s++) {
+      char name[40];
+      if (segments[s])
+        snprintf(name, sizeof(name), "segmentos de %zu", segments[s]);
+      else
+        snprintf(name, sizeof(name), "inteira");
+
+      http_parser_t parser;
+      start = bench_ns();
+      for (int r = 0; r < requests; r++)
+        bench_result = new_parse(&parser, cases[c].request, cases[c].len, segments[s]);
+      elapsed = bench_ns() - start;
+      printf("%-10s %6zu %-16s %10.1f %10.1f\n", cases[c].name, cases[c].len, name,
+             (double)elapsed / requests, (double)cases[c].len * requests * 1000.0 / elapsed);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+"""Gera o fsdata_custom.c do sistema de arquivos do httpd do lwIP a partir de public/.
+
+Cada arquivo é comprimido com gzip e armazenado junto com o cabeçalho HTTP completo
+(FS_FILE_FLAGS_HEADER_INCLUDED), para ser enviado da flash sem cópia. Não há cópia sem compressão:
+o firmware responde 406 a quem envia Accept-Encoding sem gzip, daí o "Vary: Accept-Encoding".
+
+HTML é servido com "Cache-Control: no-cache" e ETag (revalidação com 304). CSS/JS
+recebem um cache de longa duração; o HTML os referencia com "?v=<hash>" para que
+uma nova versão troque a URL.
+
+Uso: makefsdata.py <saida.c> <arquivo> [<arquivo> ...]
+"""
+
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+CONTENT_TYPES = {
+    ".html": "text/html; charset=UTF-8",
+    ".css": "text/css; charset=UTF-8",
+    ".js": "application/javascript; charset=UTF-8",
+    ".ico": "image/x-icon",
+    ".png": "image/png",
+    ".svg": "image/svg+xml",
+}
+
+LONG_CACHE = "public, max-age=31536000, immutable"
+
+
+def short_hash(data):
+    return hashlib.sha1(data).hexdigest()[:8]
+
+
+def c_identifier(name):
+    return "data_" + re.sub(r"[^A-Za-z0-9]", "_", name)
+
+
+def c_bytes(data, indent=""):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append(indent + ",".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    return "\n".join(lines)
+
+
+def main():
+    if len(sys.argv) < 3:
+        sys.exit(__doc__)
+
+    output = sys.argv[1]
+    paths = sys.argv[2:]
+    contents = {os.path.basename(p): open(p, "rb").read() for p in paths}
+
+    # Os assets com cache longo são versionados pelo conteúdo dentro do HTML
+    versions = {name: short_hash(data) for name, data in contents.items() if not name.endswith(".html")}
+    for name, data in contents.items():
+        if name.endswith(".html"):
+            for asset, version in versions.items():
+                data = re.sub(rb'((?:href|src)=")' + re.escape(asset.encode()) + rb'"',
+                              rb"\g<1>" + ("%s?v=%s" % (asset, version)).encode() + rb'"', data)
+            contents[name] = data
+
+    files = []
+    for name, data in contents.items():
+        ext = os.path.splitext(name)[1]
+        body = gzip.compress(data, compresslevel=9, mtime=0)
+        cache = "no-cache" if ext == ".html" else LONG_CACHE
+        header = (
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Type: %s\r\n"
+            "Content-Encoding: gzip\r\n"
+            "Vary: Accept-Encoding\r\n"
+            "Cache-Control: %s\r\n"
+            "ETag: \"%s\"\r\n"
+            "Content-Length: %d\r\n"
+            "\r\n" % (CONTENT_TYPES.get(ext, "application/octet-stream"), cache, short_hash(body), len(body))
+        ).encode()
+        files.append(("/" + name, header + body, len(data)))
+
+    out = []
+    out.append("/* Gerado por tools/makefsdata.py - não editar */")
+    out.append('#include "lwip/apps/fs.h"')
+    out.append('#include "lwip/def.h"')
+    out.append("")
+    out.append("#define file_NULL (struct fsdata_file *) NULL")
+    out.append("")
+
+    for name, data, original_len in files:
+        ident = c_identifier(name)
+        name_bytes = name.encode() + b"\0"
+        out.append("/* %s: %d bytes, %d comprimidos com cabeçalho */" % (name, original_len, len(data)))
+        out.append("static const unsigned char %s[] = {" % ident)
+        out.append(c_bytes(name_bytes))
+        out.append(c_bytes(data))
+        out.append("};")
+        out.append("")
+
+    previous = "file_NULL"
+    for name, data, _ in files:
+        ident = c_identifier(name)
+        name_len = len(name.encode()) + 1
+        out.append("const struct fsdata_file file_%s[] = {{" % ident[5:])
+        out.append("    %s," % previous)
+        out.append("    %s," % ident)
+        out.append("    %s + %d," % (ident, name_len))
+        out.append("    sizeof(%s) - %d," % (ident, name_len))
+        out.append("    FS_FILE_FLAGS_HEADER_INCLUDED | FS_FILE_FLAGS_HEADER_PERSISTENT,")
+        out.append("}};")
+        out.append("")
+        previous = "file_" + ident[5:]
+
+    out.append("#define FS_ROOT %s" % previous)
+    out.append("#define FS_NUMFILES %d" % len(files))
+    out.append("")
+
+    os.makedirs(os.path.dirname(os.path.abspath(output)), exist_ok=True)
+    with open(output, "w") as f:
+        f.write("\n".join(out))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,259 @@
+// Micro-benchmark da camada de desenho do SSD1306 no computador: mede ciclos por quadro da tela do
+// vDisplayTask com as primitivas por byte da biblioteca e com a versão antiga pixel a pixel, confere
+// que as duas produzem a mesma imagem e conta transações e bytes no barramento I2C (um barramento
+// simulado) com comandos em lote e com o protocolo antigo de uma transação por byte de comando.
+//
+// Uso: gcc -O2 -Itools/host -Ilib/ssd1306 tools/ssd1306_bench.c lib/ssd1306/ssd1306.c -o ssd1306_bench
+//      ./ssd1306_bench [quadros]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ssd1306.h"
+#include "font.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "ciclos"
+static inline uint64_t bench_now(void) { return __rdtsc(); }
+#else
+#define BENCH_UNIT "ns"
+static inline uint64_t bench_now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+#endif
+
+// Barramento simulado: bytes contam o byte de endereço de cada transação
+typedef struct bench_bus {
+  size_t transactions;
+  size_t bytes;
+} bench_bus_t;
+
+static bench_bus_t bench_bus;
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop)
+{
+  bench_bus.transactions++;
+  bench_bus.bytes += len + 1;
+  return (int)len;
+}
+
+// Protocolo antigo: cada byte de comando em uma transação própria (0x80 + comando)
+static void ref_command(ssd1306_t *ssd, uint8_t command)
+{
+  uint8_t buffer[2] = {0x80, command};
+  i2c_write_blocking(ssd->i2c_port, ssd->address, buffer, sizeof(buffer), false);
+}
+
+static void ref_config(ssd1306_t *ssd)
+{
+  static const uint8_t commands[] = {
+    SET_DISP | 0x00, SET_MEM_ADDR, 0x01, SET_DISP_START_LINE | 0x00, SET_SEG_REMAP | 0x01,
+    SET_MUX_RATIO, HEIGHT - 1, SET_COM_OUT_DIR | 0x08, SET_DISP_OFFSET, 0x00, SET_COM_PIN_CFG, 0x12,
+    SET_DISP_CLK_DIV, 0x80, SET_PRECHARGE, 0xF1, SET_VCOM_DESEL, 0x30, SET_CONTRAST, 0xFF,
+    SET_ENTIRE_ON, SET_NORM_INV, SET_CHARGE_PUMP, 0x14, SET_DISP | 0x01,
+  };
+  for (size_t i = 0; i < sizeof(commands); i++)
+    ref_command(ssd, commands[i]);
+}
+
+// Mesmas janelas de ssd1306_send_data, com os 6 comandos da janela em transações separadas
+static void ref_send_data(ssd1306_t *ssd)
+{
+  uint8_t page = 0;
+  while (page < ssd->pages) {
+    if (ssd->dirty_left[page] > ssd->dirty_right[page]) {
+      page++;
+      continue;
+    }
+    uint8_t page0 = page, left = ssd->dirty_left[page], right = ssd->dirty_right[page];
+    while (++page < ssd->pages && ssd->dirty_left[page] <= ssd->dirty_right[page]) {
+      if (ssd->dirty_left[page] < left)
+        left = ssd->dirty_left[page];
+      if (ssd->dirty_right[page] > right)
+        right = ssd->dirty_right[page];
+    }
+
+    const uint8_t commands[] = {SET_COL_ADDR, left, right, SET_PAGE_ADDR, page0, page - 1};
+    for (size_t i = 0; i < sizeof(commands); i++)
+      ref_command(ssd, commands[i]);
+    i2c_write_blocking(ssd->i2c_port, ssd->address, ssd->ram_buffer, 1 + (right - left + 1) * (page - page0), false);
+  }
+  memset(ssd->dirty_left, 0xFF, sizeof(ssd->dirty_left));
+  memset(ssd->dirty_right, 0x00, sizeof(ssd->dirty_right));
+}
+
+// Versão antiga: todas as primitivas desenham pixel a pixel
+static void ref_fill(ssd1306_t *ssd, bool value)
+{
+  for (uint8_t y = 0; y < ssd->height; ++y)
+    for (uint8_t x = 0; x < ssd->width; ++x)
+      ssd1306_pixel(ssd, x, y, value);
+}
+
+static void ref_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill)
+{
+  for (uint8_t x = left; x < left + width; ++x) {
+    ssd1306_pixel(ssd, x, top, value);
+    ssd1306_pixel(ssd, x, top + height - 1, value);
+  }
+  for (uint8_t y = top; y < top + height; ++y) {
+    ssd1306_pixel(ssd, left, y, value);
+    ssd1306_pixel(ssd, left + width - 1, y, value);
+  }
+  if (fill)
+    for (uint8_t x = left + 1; x < left + width - 1; ++x)
+      for (uint8_t y = top + 1; y < top + height - 1; ++y)
+        ssd1306_pixel(ssd, x, y, value);
+}
+
+static void ref_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y)
+{
+  while (*str) {
+    char c = *str++;
+    uint16_t index = (c >= ' ' && c <= '~') ? (c - ' ') * 8 : 0;
+    for (uint8_t i = 0; i < 8; ++i)
+      for (uint8_t j = 0; j < 8; ++j)
+        ssd1306_pixel(ssd, x + i, y + j, font[index + i] & (1 << j));
+    x += 8;
+    if (x + 8 >= ssd->width) {
+      x = 0;
+      y += 8;
+    }
+    if (y + 8 >= ssd->height)
+      break;
+  }
+}
+
+typedef struct bench_ops {
+  const char *name;
+  void (*fill)(ssd1306_t *ssd, bool value);
+  void (*rect)(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill);
+  void (*draw_string)(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
+} bench_ops_t;
+
+static const bench_ops_t bench_variants[] = {
+  {"por byte", ssd1306_fill, ssd1306_rect, ssd1306_draw_string},
+  {"por pixel", ref_fill, ref_rect, ref_draw_string},
+};
+
+static const char *const bench_rows[] = {"1: Livre", "2: Ocupada", "3: Reservada", "4: Livre"};
+
+// Tela completa do vDisplayTask: título, resumo e as quatro linhas de vagas
+static void bench_full_frame(ssd1306_t *ssd, const bench_ops_t *ops)
+{
+  ops->fill(ssd, false);
+  ops->draw_string(ssd, "Estacionamento", (128 - 14 * 8) / 2, 0);
+  ops->rect(ssd, 16, 0, WIDTH, 8, false, true);
+  ops->draw_string(ssd, "A:1 B:2 PCD:1", 0, 16);
+  for (int i = 0; i < 4; i++) {
+    ops->rect(ssd, (i * 8) + 32, 0, WIDTH, 8, false, true);
+    ops->draw_string(ssd, bench_rows[i], 5, (i * 8) + 32);
+  }
+}
+
+// Atualização típica: resumo e a linha de uma vaga alterada
+static void bench_update_frame(ssd1306_t *ssd, const bench_ops_t *ops)
+{
+  ops->rect(ssd, 16, 0, WIDTH, 8, false, true);
+  ops->draw_string(ssd, "A:0 B:2 PCD:1", 0, 16);
+  ops->rect(ssd, 32, 0, WIDTH, 8, false, true);
+  ops->draw_string(ssd, "1: Ocupada", 5, 32);
+}
+
+// Rótulo fixo desenhado glifo a glifo, com a fonte proporcional e a partir do texto já renderizado
+static ssd1306_run_t bench_title_run;
+
+static void bench_title_string(ssd1306_t *ssd, const bench_ops_t *ops)
+{
+  ssd1306_draw_string(ssd, "Estacionamento", 8, 0);
+}
+
+static void bench_title_text(ssd1306_t *ssd, const bench_ops_t *ops)
+{
+  ssd1306_draw_text(ssd, &ssd1306_font_proportional, "Estacionamento", 8, 0);
+}
+
+static void bench_title_run_draw(ssd1306_t *ssd, const bench_ops_t *ops)
+{
+  ssd1306_draw_run(ssd, &bench_title_run, 8, 0);
+}
+
+// Menor tempo por quadro entre as repetições (menos ruído do sistema)
+static uint64_t bench_run(ssd1306_t *ssd, const bench_ops_t *ops, void (*frame)(ssd1306_t *, const bench_ops_t *), int frames)
+{
+  uint64_t best = UINT64_MAX;
+  for (int round = 0; round < 10; round++) {
+    uint64_t start = bench_now();
+    for (int i = 0; i < frames; i++)
+      frame(ssd, ops);
+    uint64_t elapsed = (bench_now() - start) / frames;
+    if (elapsed < best)
+      best = elapsed;
+  }
+  return best;
+}
+
+int main(int argc, char **argv)
+{
+  int frames = (argc > 1) ? atoi(argv[1]) : 2000;
+  if (frames < 1)
+    frames = 1;
+
+  ssd1306_t ssd[2];
+  for (int v = 0; v < 2; v++) {
+    ssd1306_init(&ssd[v], WIDTH, HEIGHT, false, 0x3C, NULL);
+    bench_full_frame(&ssd[v], &bench_variants[v]);
+    bench_update_frame(&ssd[v], &bench_variants[v]);
+  }
+  if (memcmp(ssd[0].ram_buffer, ssd[1].ram_buffer, ssd[0].bufsize) != 0) {
+    fprintf(stderr, "imagens diferentes entre as versões por byte e por pixel\n");
+    return 1;
+  }
+
+  // Barramento: configuração, quadro completo e, em seguida, a atualização de uma vaga
+  void (*const configs[2])(ssd1306_t *) = {ssd1306_config, ref_config};
+  void (*const sends[2])(ssd1306_t *) = {ssd1306_send_data, ref_send_data};
+  bench_bus_t bus[2][3];
+  for (int p = 0; p < 2; p++) {
+    ssd1306_t display;
+    ssd1306_init(&display, WIDTH, HEIGHT, false, 0x3C, NULL);
+    bench_bus = (bench_bus_t){0};
+    configs[p](&display);
+    bus[p][0] = bench_bus;
+    bench_full_frame(&display, &bench_variants[0]);
+    bench_bus = (bench_bus_t){0};
+    sends[p](&display);
+    bus[p][1] = bench_bus;
+    bench_update_frame(&display, &bench_variants[0]);
+    bench_bus = (bench_bus_t){0};
+    sends[p](&display);
+    bus[p][2] = bench_bus;
+  }
+
+  printf("%-10s %16s %16s\n", "versão", "quadro completo", "atualização");
+  for (int v = 0; v < 2; v++)
+    printf("%-10s %9llu %-6s %9llu %-6s\n", bench_variants[v].name,
+           (unsigned long long)bench_run(&ssd[v], &bench_variants[v], bench_full_frame, frames), BENCH_UNIT,
+           (unsigned long long)bench_run(&ssd[v], &bench_variants[v], bench_update_frame, frames), BENCH_UNIT);
+
+  static uint8_t title_columns[WIDTH];
+  ssd1306_run_render(&bench_title_run, &ssd1306_font_proportional, "Estacionamento", title_columns, sizeof(title_columns));
+  printf("\n\"Estacionamento\": 8x8 %llu, proporcional %llu, em cache %llu %s\n",
+         (unsigned long long)bench_run(&ssd[0], NULL, bench_title_string, frames),
+         (unsigned long long)bench_run(&ssd[0], NULL, bench_title_text, frames),
+         (unsigned long long)bench_run(&ssd[0], NULL, bench_title_run_draw, frames), BENCH_UNIT);
+
+  static const char *const protocols[2] = {"em lote", "separados"};
+  printf("\nI2C (transações/bytes) %12s %16s %12s\n", "config", "quadro completo", "atualização");
+  for (int p = 0; p < 2; p++)
+    printf("comandos %-13s %6zu/%-5zu %9zu/%-6zu %7zu/%-5zu\n", protocols[p],
+           bus[p][0].transactions, bus[p][0].bytes, bus[p][1].transactions, bus[p][1].bytes,
+           bus[p][2].transactions, bus[p][2].bytes);
+  return 0;
+}
@@ -0,0 +1,55 @@
+#!/usr/bin/env python3
+"""Mede o tempo até o primeiro byte (TTFB) das respostas do servidor web da placa.
+
+Cada amostra abre uma conexão nova, envia a requisição e mede o tempo entre o envio e o
+primeiro byte recebido (o tempo de conexão é reportado à parte).
+
+Uso: ttfb.py <ip-da-placa> [caminho] [amostras]
+"""
+
+import socket
+import statistics
+import sys
+import time
+
+
+def sample(host, path):
+    start = time.perf_counter()
+    with socket.create_connection((host, 80), timeout=5) as sock:
+        connected = time.perf_counter()
+        sock.sendall(("GET %s HTTP/1.1\r\nHost: %s\r\nConnection: close\r\n\r\n" % (path, host)).encode())
+        sent = time.perf_counter()
+        sock.recv(1)
+        first_byte = time.perf_counter()
+    return (connected - start) * 1000, (first_byte - sent) * 1000
+
+
+def report(name, values):
+    values = sorted(values)
+    p95 = values[min(len(values) - 1, int(len(values) * 0.95))]
+    print("%-8s min %7.2f  mediana %7.2f  p95 %7.2f  max %7.2f ms" %
+          (name, values[0], statistics.median(values), p95, values[-1]))
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit(__doc__)
+
+    host = sys.argv[1]
+    path = sys.argv[2] if len(sys.argv) > 2 else "/api/status"
+    count = int(sys.argv[3]) if len(sys.argv) > 3 else 50
+
+    connect, ttfb = [], []
+    for _ in range(count):
+        c, t = sample(host, path)
+        connect.append(c)
+        ttfb.append(t)
+        time.sleep(0.05)
+
+    print("%d amostras de GET %s em %s" % (count, path, host))
+    report("conexão", connect)
+    report("TTFB", ttfb)
+
+
+if __name__ == "__main__":
+    main()
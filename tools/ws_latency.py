@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+"""Mede o tempo de ida e volta de uma reserva pelo WebSocket e pelo fluxo antigo de formulário.
+
+WebSocket: uma conexão persistente em /ws; cada amostra envia "reservar:N" e espera o evento da
+vaga N com status reservado. Formulário: cada amostra abre conexões novas para
+GET /reservar-vaga-N e, seguindo o redirecionamento, para GET / e GET /api/status (o que a página
+recarregada pede para mostrar a vaga).
+
+Antes de cada amostra a vaga é liberada com GET /liberar-vaga-N.
+
+Uso: ws_latency.py <ip-da-placa> [vaga] [amostras]
+"""
+
+import base64
+import json
+import os
+import socket
+import statistics
+import sys
+import time
+
+
+def http_get(host, path):
+    """GET com conexão nova, lendo a resposta até o servidor fechar."""
+    with socket.create_connection((host, 80), timeout=5) as sock:
+        sock.sendall(("GET %s HTTP/1.1\r\nHost: %s\r\nConnection: close\r\n\r\n" % (path, host)).encode())
+        while sock.recv(4096):
+            pass
+
+
+class WebSocket:
+    def __init__(self, host):
+        self.sock = socket.create_connection((host, 80), timeout=5)
+        key = base64.b64encode(os.urandom(16)).decode()
+        self.sock.sendall(("GET /ws HTTP/1.1\r\nHost: %s\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                           "Sec-WebSocket-Key: %s\r\nSec-WebSocket-Version: 13\r\n\r\n" % (host, key)).encode())
+        self.buffer = b""
+        while b"\r\n\r\n" not in self.buffer:
+            self.buffer += self.recv()
+        status, self.buffer = self.buffer.split(b"\r\n\r\n", 1)
+        if b" 101 " not in status.split(b"\r\n", 1)[0]:
+            raise RuntimeError("upgrade recusado: %r" % status.split(b"\r\n", 1)[0])
+
+    def recv(self):
+        data = self.sock.recv(4096)
+        if not data:
+            raise RuntimeError("conexão encerrada pela placa")
+        return data
+
+    def send_text(self, text):
+        payload = text.encode()
+        mask = os.urandom(4)
+        masked = bytes(b ^ mask[i & 3] for i, b in enumerate(payload))
+        self.sock.sendall(bytes([0x81, 0x80 | len(payload)]) + mask + masked)
+
+    def read_message(self):
+        """Próximo quadro do servidor (sem máscara, payload < 64 KB)."""
+        while True:
+            if len(self.buffer) >= 2:
+                length, header = self.buffer[1] & 0x7F, 2
+                if length == 126 and len(self.buffer) >= 4:
+                    length, header = int.from_bytes(self.buffer[2:4], "big"), 4
+                if length != 126 and len(self.buffer) >= header + length:
+                    opcode = self.buffer[0] & 0x0F
+                    payload = self.buffer[header:header + length]
+                    self.buffer = self.buffer[header + length:]
+                    if opcode == 0x8:
+                        raise RuntimeError("a placa fechou o WebSocket")
+                    if opcode == 0x1:
+                        return payload.decode()
+                    continue
+            self.buffer += self.recv()
+
+    def close(self):
+        self.sock.close()
+
+
+def wait_status(ws, spot, status):
+    """Descarta eventos até a vaga chegar ao status (os eventos de outras amostras ficam para trás)."""
+    while True:
+        event = json.loads(ws.read_message())
+        if event.get("id") == spot and event.get("s") == status:
+            return
+
+
+def ws_sample(ws, spot):
+    start = time.perf_counter()
+    ws.send_text("reservar:%d" % spot)
+    wait_status(ws, spot, 2)
+    return (time.perf_counter() - start) * 1000
+
+
+def form_sample(host, spot):
+    start = time.perf_counter()
+    http_get(host, "/reservar-vaga-%d" % spot)
+    http_get(host, "/")
+    http_get(host, "/api/status")
+    return (time.perf_counter() - start) * 1000
+
+
+def report(name, values):
+    values = sorted(values)
+    p95 = values[min(len(values) - 1, int(len(values) * 0.95))]
+    print("%-12s min %7.2f  mediana %7.2f  p95 %7.2f  max %7.2f ms" %
+          (name, values[0], statistics.median(values), p95, values[-1]))
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit(__doc__)
+
+    host = sys.argv[1]
+    spot = int(sys.argv[2]) if len(sys.argv) > 2 else 1
+    count = int(sys.argv[3]) if len(sys.argv) > 3 else 30
+
+    ws = WebSocket(host)
+    ws.read_message()  # Estado completo enviado na abertura
+    http_get(host, "/liberar-vaga-%d" % spot)
+    http_get(host, "/reservar-vaga-%d" % spot)  # Estado conhecido: as liberações abaixo sempre geram evento
+    wait_status(ws, spot, 2)
+
+    websocket, form = [], []
+    for _ in range(count):
+        http_get(host, "/liberar-vaga-%d" % spot)
+        wait_status(ws, spot, 0)
+        websocket.append(ws_sample(ws, spot))
+
+        http_get(host, "/liberar-vaga-%d" % spot)
+        wait_status(ws, spot, 0)
+        form.append(form_sample(host, spot))
+        wait_status(ws, spot, 2)
+    ws.close()
+    http_get(host, "/liberar-vaga-%d" % spot)
+
+    print("%d reservas da vaga %d em %s" % (count, spot, host))
+    report("WebSocket", websocket)
+    report("formulário", form)
+
+
+if __name__ == "__main__":
+    main()